@@ -0,0 +1,150 @@
+/*
+ * EventLoop.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ */
+
+#include <EventLoop.h>
+#include <PollingHAL/SWTimer.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <stddef.h>
+
+/* Marks the end of a per-event chain of records in a dispatch pass. */
+#define NO_RECORD                   (0xFF)
+
+/**
+ * The dispatch table. [handlers] is indexed by event ID, and each entry of
+ * [priorityMasks] is a bitfield (see [EVENT_BIT()]) of the event IDs whose
+ * handlers were registered at that priority. An event ID is in at most one
+ * priority mask, and only if it has a handler.
+ */
+struct _EventLoop
+{
+    EventHandler handlers[NUM_EVENT_IDS];
+    uint32_t priorityMasks[NUM_EVENT_PRIORITIES];
+};
+typedef struct _EventLoop EventLoop;
+
+/* The single instance of our dispatch table. Zero-initialized at startup, so
+ * no events are handled until handlers are registered. */
+static EventLoop s_loop;
+
+/**
+ * The records drained in one dispatch pass. [first] and [last] hold the first
+ * and last record of each event ID, and [next] chains each record to the next
+ * one of the same event. This is several hundred bytes, so it lives here rather
+ * than on the 512-byte stack, which the handlers and every ISR which preempts
+ * them still need. Only [EventLoop_dispatch()] uses it, from the main
+ * application.
+ */
+struct _EventBatch
+{
+    Event records[EVENT_QUEUE_CAPACITY];
+    uint8_t next[EVENT_QUEUE_CAPACITY];
+    uint8_t first[NUM_EVENT_IDS];
+    uint8_t last[NUM_EVENT_IDS];
+};
+typedef struct _EventBatch EventBatch;
+
+static EventBatch s_batch;
+
+/**
+ * Registers a handler for an event at normal priority. See
+ * [EventLoop_onWithPriority()].
+ *
+ * @param id:       The event ID to handle
+ * @param handler:  The function to call for each record of that event
+ */
+void EventLoop_on(EventId id, EventHandler handler)
+{
+    EventLoop_onWithPriority(id, handler, EVENT_PRIORITY_NORMAL);
+}
+
+/**
+ * Registers a handler for an event, replacing any previous handler for that
+ * event. Passing a NULL handler unregisters the event, and its records are then
+ * discarded during dispatch.
+ *
+ * @param id:       The event ID to handle
+ * @param handler:  The function to call for each record of that event
+ * @param priority: The priority to run this handler at during dispatch
+ */
+void EventLoop_onWithPriority(
+    EventId id, EventHandler handler, EventPriority priority)
+{
+    int i;
+    for (i = 0; i < NUM_EVENT_PRIORITIES; i++)
+        s_loop.priorityMasks[i] &= ~EVENT_BIT(id);
+
+    s_loop.handlers[id] = handler;
+
+    if (handler != NULL)
+        s_loop.priorityMasks[priority] |= EVENT_BIT(id);
+}
+
+/**
+ * Handles every event logged since the last dispatch pass. Call this once after
+ * every [SleepProcessor()].
+ *
+ * First, the pending set is taken and the event queue is drained into a static
+ * batch, chaining the records of each event ID together in the order they
+ * occurred. Then, for each priority from highest to lowest, only the set bits
+ * of the pending set at that priority are visited, using count-leading-zeros to
+ * jump straight to the next one. The cost of a pass is therefore proportional
+ * to the number of records and events which fired, not the number of handlers.
+ */
+void EventLoop_dispatch(void)
+{
+    /* Take the pending set BEFORE draining the queue. An event logged in
+     * between has its record drained here and its bit left set for the next
+     * pass, which then simply finds no records for it. If nothing is pending,
+     * there is nothing in the queue either and we are done after one load. */
+    uint32_t pending = InterruptHal_TakeEvents();
+    if (pending == 0)
+        return;
+
+    /* [pending] only tells us WHICH events fired. Rebuild it from the records
+     * we actually drained, so that every bit we visit below has at least one
+     * record chained to it. */
+    pending = 0;
+    uint8_t count = 0;
+
+    while ((count < EVENT_QUEUE_CAPACITY)
+        && InterruptHal_NextEvent(&s_batch.records[count]))
+    {
+        EventId id = s_batch.records[count].id;
+
+        if (pending & EVENT_BIT(id))
+            s_batch.next[s_batch.last[id]] = count;
+        else
+            s_batch.first[id] = count;
+
+        s_batch.last[id] = count;
+        s_batch.next[count] = NO_RECORD;
+        pending |= EVENT_BIT(id);
+        count++;
+    }
+
+    int priority;
+    for (priority = 0; priority < NUM_EVENT_PRIORITIES; priority++)
+    {
+        uint32_t ids = pending & s_loop.priorityMasks[priority];
+
+        while (ids != 0)
+        {
+            uint32_t id = 31 - __CLZ(ids);
+            ids &= ~EVENT_BIT(id);
+
+            EventHandler handler = s_loop.handlers[id];
+            uint8_t record;
+            for (record = s_batch.first[id]; record != NO_RECORD;
+                 record = s_batch.next[record])
+            {
+                uint64_t start = Clock_now();
+                handler(&s_batch.records[record]);
+                InterruptHal_LogHandled((EventId) id, start);
+            }
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/*
+ * EventLoop.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  A table-driven event dispatcher for the main loop. Rather than checking
+ *  every event source with a chain of if-statements, register a handler per
+ *  event ID once with [EventLoop_on()], then call [EventLoop_dispatch()] after
+ *  every [SleepProcessor()]. Only the sources which actually fired are looked
+ *  at, so the cost of a dispatch pass does not grow with the number of sources.
+ */
+
+#ifndef EVENTLOOP_H_
+#define EVENTLOOP_H_
+
+#include <InterruptHAL.h>
+
+/**
+ * Handler priorities. During a dispatch pass, every handler of a higher
+ * priority runs before any handler of a lower priority. Within a priority,
+ * handlers of higher event IDs run first. Records of the same event are always
+ * handed over in the order they occurred.
+ */
+enum _EventPriority
+{
+    EVENT_PRIORITY_HIGH,
+    EVENT_PRIORITY_NORMAL,
+    EVENT_PRIORITY_LOW,
+
+    NUM_EVENT_PRIORITIES
+};
+typedef enum _EventPriority EventPriority;
+
+/**
+ * An event handler. Called once per record logged by the event's ISR. If the
+ * event's policy coalesces repeats, [event->count] says how many occurrences
+ * the record stands for.
+ */
+typedef void (*EventHandler)(const Event* event);
+
+/* Registers [handler] for [id], replacing any previous handler for that ID. */
+void EventLoop_on(EventId id, EventHandler handler);
+void EventLoop_onWithPriority(
+    EventId id, EventHandler handler, EventPriority priority);
+
+/* Handles every event which fired since the last dispatch pass. */
+void EventLoop_dispatch(void);
+
+#endif /* EVENTLOOP_H_ */
@@ -0,0 +1,157 @@
+/*
+ * EventQueue.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ */
+
+#include <EventQueue.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <stddef.h>
+
+/**
+ * Finds the newest record in the queue with the given ID and gesture which the
+ * consumer has not claimed yet. Producer side only.
+ *
+ * @return the record, or NULL if there is none
+ */
+static volatile Event* FindUnclaimed(
+    EventQueue* queue, EventId id, Gesture gesture)
+{
+    uint32_t index;
+    for (index = queue->head; index != queue->tail; index--)
+    {
+        volatile Event* record = &queue->buffer[(index - 1) & EVENT_QUEUE_MASK];
+
+        if (record->count != 0
+            && record->id == id && record->gesture == gesture)
+            return record;
+    }
+
+    return NULL;
+}
+
+/**
+ * Empties the queue and resets its overflow counter. Call this before any ISR
+ * which pushes into the queue is enabled.
+ */
+void EventQueue_init(EventQueue* queue)
+{
+    queue->head = 0;
+    queue->tail = 0;
+    queue->overflows = 0;
+}
+
+/**
+ * Appends an event record to the queue. The record is written BEFORE [head] is
+ * advanced, so the consumer can never observe a slot which is only partially
+ * filled in.
+ *
+ * @param queue:    The queue to push into
+ * @param event:    The record to append
+ * @return true if the record was queued, false if it was dropped
+ */
+bool EventQueue_push(EventQueue* queue, Event event)
+{
+    uint32_t head = queue->head;
+
+    if (head - queue->tail >= EVENT_QUEUE_CAPACITY)
+    {
+        queue->overflows++;
+        return false;
+    }
+
+    queue->buffer[head & EVENT_QUEUE_MASK] = event;
+    queue->head = head + 1;
+
+    return true;
+}
+
+/**
+ * Merges an event into the newest queued record of the same ID and gesture,
+ * as long as that record was logged no more than [window] cycles before the
+ * event. The record keeps its original timestamp and counts one more
+ * occurrence.
+ *
+ * @param queue:    The queue to merge into
+ * @param event:    The event to merge
+ * @param window:   The longest time a record may merge repeats for, in cycles
+ * @return true if the event was merged, false if it still needs to be pushed
+ */
+bool EventQueue_coalesce(EventQueue* queue, Event event, uint64_t window)
+{
+    volatile Event* record = FindUnclaimed(queue, event.id, event.gesture);
+
+    if (record == NULL || event.timestamp - record->timestamp > window)
+        return false;
+
+    record->count++;
+    return true;
+}
+
+/**
+ * Replaces the newest queued record of the same ID and gesture with an event,
+ * so that only the latest occurrence is handed to the consumer. The record
+ * takes the event's timestamp and counts one more occurrence.
+ *
+ * @param queue:    The queue to update
+ * @param event:    The event to keep instead of the queued record
+ * @return true if a record was replaced, false if the event needs to be pushed
+ */
+bool EventQueue_replace(EventQueue* queue, Event event)
+{
+    volatile Event* record = FindUnclaimed(queue, event.id, event.gesture);
+
+    if (record == NULL)
+        return false;
+
+    record->timestamp = event.timestamp;
+    record->count++;
+    return true;
+}
+
+/**
+ * Removes the oldest event record from the queue. The record is first claimed
+ * by swapping its count with 0 in a single exclusive load/store pair, so the
+ * producer stops merging into it before we copy it out. If the producer
+ * merges between the load and the store, the store fails and we simply try
+ * again. The record is copied out BEFORE [tail] is advanced, so the producer
+ * can never overwrite a slot which is still being read.
+ *
+ * @param queue:    The queue to pop from
+ * @param event:    Filled in with the oldest record, if there is one
+ * @return true if a record was removed, false if the queue was empty
+ */
+bool EventQueue_pop(EventQueue* queue, Event* event)
+{
+    uint32_t tail = queue->tail;
+
+    if (tail == queue->head)
+        return false;
+
+    volatile Event* record = &queue->buffer[tail & EVENT_QUEUE_MASK];
+    uint32_t count;
+
+    do
+    {
+        count = __LDREXW(&record->count);
+    } while (__STREXW(0, &record->count) != 0);
+
+    *event = *record;
+    event->count = count;
+    queue->tail = tail + 1;
+
+    return true;
+}
+
+/** Returns whether there are no records waiting to be popped. */
+bool EventQueue_isEmpty(EventQueue* queue)
+{
+    return queue->tail == queue->head;
+}
+
+/** Returns the number of records dropped since the queue was initialized. */
+uint32_t EventQueue_overflows(EventQueue* queue)
+{
+    return queue->overflows;
+}
@@ -0,0 +1,108 @@
+/*
+ * EventQueue.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  A fixed-capacity, single-producer/single-consumer ring of event records.
+ *  ISRs push records into the queue and the main loop drains them, so no event
+ *  is lost when the same source fires twice before [main()] gets to run, and
+ *  events are handed to the application in the order they were logged.
+ */
+
+#ifndef EVENTQUEUE_H_
+#define EVENTQUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <InputPins.h>
+
+/* The number of records the queue can hold. MUST be a power of two so that the
+ * free-running head and tail indices can be wrapped with a mask. */
+#define EVENT_QUEUE_CAPACITY        (16)
+#define EVENT_QUEUE_MASK            (EVENT_QUEUE_CAPACITY - 1)
+
+/**
+ * Identifies the source of an event. Every pin in [INPUT_PIN_TABLE()] gets an
+ * ID automatically, in the order of the table.
+ *
+ * TODO: Add more event IDs after the pin IDs as you add ISRs which are not
+ *       GPIO inputs to your system.
+ */
+#define EVENT_ID_FROM_PIN(id, port, pin, edge, pull, debounce, gestures)  id,
+
+enum _EventId
+{
+    INPUT_PIN_TABLE(EVENT_ID_FROM_PIN)
+
+    NUM_EVENT_IDS
+};
+typedef enum _EventId EventId;
+
+/* The bit which represents an event ID in a pending-event bitfield, such as the
+ * one returned by [InterruptHal_TakeEvents()]. Event IDs must fit in 32 bits. */
+#define EVENT_BIT(id)               (1u << (id))
+
+/** A single event record, as logged by an ISR. */
+struct _Event
+{
+    EventId id;
+
+    /* For buttons, what the button did. GESTURE_NONE for every other event. */
+    Gesture gesture;
+
+    /* How many occurrences this record stands for. Always 1, unless the event
+     * source's policy merged later occurrences into this record. 0 is used
+     * internally to mark a record which the consumer is already popping. */
+    uint32_t count;
+
+    /* When the ISR which logged this event was entered, from [Clock_now()].
+     * Compare against [Clock_now()] in a handler to measure how long the event
+     * waited to be dispatched. */
+    uint64_t timestamp;
+};
+typedef struct _Event Event;
+
+/**
+ * The queue itself. Only one context may push (the ISRs, which all share the
+ * same NVIC priority and therefore cannot preempt each other) and only one
+ * context may pop (the main loop). Under that rule no locking is needed: the
+ * producer only ever writes [head], the consumer only ever writes [tail].
+ *
+ * The producer may also update records which are still queued, to coalesce
+ * repeats. To pop a record, the consumer first claims it by atomically setting
+ * its [count] to 0, and the producer never touches a claimed record.
+ *
+ * As with the SWTimer, treat all members as PRIVATE.
+ */
+struct _EventQueue
+{
+    volatile Event buffer[EVENT_QUEUE_CAPACITY];
+
+    /* Free-running indices. [head - tail] is the number of queued records. */
+    volatile uint32_t head;
+    volatile uint32_t tail;
+
+    /* The number of records rejected because the queue was full. */
+    volatile uint32_t overflows;
+};
+typedef struct _EventQueue EventQueue;
+
+void EventQueue_init(EventQueue* queue);
+
+/* Producer side - call only from ISRs. Returns false if the queue was full. */
+bool EventQueue_push(EventQueue* queue, Event event);
+
+/* Producer side - merge [event] into the newest queued record of the same ID
+ * and gesture instead of pushing it. Return false if there is no such record
+ * (or, for coalescing, if it is older than the window) and nothing changed. */
+bool EventQueue_coalesce(EventQueue* queue, Event event, uint64_t window);
+bool EventQueue_replace(EventQueue* queue, Event event);
+
+/* Consumer side - call only from the main loop. Returns false if empty. */
+bool EventQueue_pop(EventQueue* queue, Event* event);
+
+bool EventQueue_isEmpty(EventQueue* queue);
+uint32_t EventQueue_overflows(EventQueue* queue);
+
+#endif /* EVENTQUEUE_H_ */
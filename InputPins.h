@@ -0,0 +1,101 @@
+/*
+ * InputPins.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  The table of every GPIO pin which generates events. Each row describes one
+ *  input, and everything else is generated from this table: the event IDs in
+ *  EventQueue.h, the pin initialization, and the per-port ISRs in
+ *  InterruptHAL.c. To add a button, add a row here - nothing else needs to be
+ *  copied and pasted.
+ *
+ *  This file is an "X-macro": [INPUT_PIN_TABLE(X)] calls [X()] once per row,
+ *  and every user of the table defines [X()] to pull out the columns it needs.
+ */
+
+#ifndef INPUTPINS_H_
+#define INPUTPINS_H_
+
+/* The default debounce time for mechanical buttons, in milliseconds. */
+#define DEBOUNCE_TIME_MS            (50)
+
+/* Gesture thresholds, in milliseconds. A button held for GESTURE_LONG_PRESS_MS
+ * is a long press, after which it auto-repeats every GESTURE_REPEAT_MS until it
+ * is released. A press within GESTURE_DOUBLE_TAP_MS of the previous release is
+ * a double tap. Long presses and repeats must stay under 4000 ms. */
+#define GESTURE_LONG_PRESS_MS       (800)
+#define GESTURE_REPEAT_MS           (200)
+#define GESTURE_DOUBLE_TAP_MS       (300)
+
+/** Which internal resistor, if any, to enable on an input pin. */
+enum _InputPull
+{
+    INPUT_PULL_NONE,    // The board already has an external pull resistor
+    INPUT_PULL_UP,
+    INPUT_PULL_DOWN
+};
+typedef enum _InputPull InputPull;
+
+/**
+ * What happened to a button, carried in every event record. Events which do
+ * not come from a button are always GESTURE_NONE.
+ * - GESTURE_PRESS:         The button went down
+ * - GESTURE_RELEASE:       The button came back up
+ * - GESTURE_LONG_PRESS:    The button has been held for GESTURE_LONG_PRESS_MS
+ * - GESTURE_REPEAT:        The button is still held, every GESTURE_REPEAT_MS
+ *                          after the long press
+ * - GESTURE_DOUBLE_TAP:    The button went down again soon after a tap. This
+ *                          is logged right after the second GESTURE_PRESS.
+ */
+enum _Gesture
+{
+    GESTURE_NONE,
+    GESTURE_PRESS,
+    GESTURE_RELEASE,
+    GESTURE_LONG_PRESS,
+    GESTURE_REPEAT,
+    GESTURE_DOUBLE_TAP
+};
+typedef enum _Gesture Gesture;
+
+/* The bit which represents a gesture in the gestures column of the table. */
+#define GESTURE_BIT(gesture)        (1u << (gesture))
+
+#define GESTURES_PRESS_ONLY         (GESTURE_BIT(GESTURE_PRESS))
+#define GESTURES_ALL                (GESTURE_BIT(GESTURE_PRESS)               \
+                                   | GESTURE_BIT(GESTURE_RELEASE)             \
+                                   | GESTURE_BIT(GESTURE_LONG_PRESS)          \
+                                   | GESTURE_BIT(GESTURE_REPEAT)              \
+                                   | GESTURE_BIT(GESTURE_DOUBLE_TAP))
+
+/**
+ * Columns:
+ * - id:        The event ID logged when this pin fires
+ * - port:      GPIO_PORT_P1 through GPIO_PORT_P6 (only these ports interrupt)
+ * - pin:       GPIO_PIN0 through GPIO_PIN7
+ * - edge:      GPIO_HIGH_TO_LOW_TRANSITION or GPIO_LOW_TO_HIGH_TRANSITION
+ * - pull:      An [InputPull]
+ * - debounce:  How long the pin must stay quiet after an edge, in milliseconds
+ * - gestures:  The [GESTURE_BIT()]s of the gestures to log for this pin
+ *
+ * TODO: Add a row for every new button or GPIO input you use.
+ */
+#define INPUT_PIN_TABLE(X)                                                     \
+    X(EVENT_LAUNCHPAD_S1,   GPIO_PORT_P1, GPIO_PIN1,                           \
+      GPIO_HIGH_TO_LOW_TRANSITION, INPUT_PULL_UP,   DEBOUNCE_TIME_MS,          \
+      GESTURES_PRESS_ONLY)                                                     \
+    X(EVENT_LAUNCHPAD_S2,   GPIO_PORT_P1, GPIO_PIN4,                           \
+      GPIO_HIGH_TO_LOW_TRANSITION, INPUT_PULL_UP,   DEBOUNCE_TIME_MS,          \
+      GESTURES_ALL)                                                            \
+    X(EVENT_BOOSTERPACK_S1, GPIO_PORT_P5, GPIO_PIN1,                           \
+      GPIO_HIGH_TO_LOW_TRANSITION, INPUT_PULL_NONE, DEBOUNCE_TIME_MS,          \
+      GESTURES_PRESS_ONLY)                                                     \
+    X(EVENT_BOOSTERPACK_S2, GPIO_PORT_P3, GPIO_PIN5,                           \
+      GPIO_HIGH_TO_LOW_TRANSITION, INPUT_PULL_NONE, DEBOUNCE_TIME_MS,          \
+      GESTURES_PRESS_ONLY)                                                     \
+    X(EVENT_BOOSTERPACK_JS, GPIO_PORT_P4, GPIO_PIN1,                           \
+      GPIO_HIGH_TO_LOW_TRANSITION, INPUT_PULL_NONE, DEBOUNCE_TIME_MS,          \
+      GESTURES_PRESS_ONLY)
+
+#endif /* INPUTPINS_H_ */
@@ -28,6 +28,146 @@
 
 #include <InterruptHAL.h>
 #include <PollingHAL/SWTimer.h>
+#include <Profiler.h>
+#include <stddef.h>
+
+/******************************************************************************/
+/* INPUT PIN TABLE                                                            */
+/******************************************************************************/
+
+/* Only ports P1 through P6 can generate interrupts on the MSP432P401R. */
+#define NUM_INPUT_PORTS             (6)
+#define NUM_PINS_PER_PORT           (8)
+#define NO_INPUT_PIN                (0xFF)
+
+/* Converts a GPIO_PORT_Px value into an index into the per-port arrays. */
+#define PORT_INDEX(port)            ((port) - GPIO_PORT_P1)
+
+/** One row of [INPUT_PIN_TABLE()]. See InputPins.h for what each column is. */
+struct _InputPin
+{
+    EventId id;
+    uint_fast8_t port;
+    uint_fast16_t pin;
+    uint_fast8_t edge;
+    InputPull pull;
+    uint32_t debounceMs;
+    uint32_t gestures;
+};
+typedef struct _InputPin InputPin;
+
+#define INPUT_PIN_ROW(id, port, pin, edge, pull, debounce, gestures)           \
+    { id, port, pin, edge, pull, debounce, gestures },
+
+static const InputPin s_inputPinTable[] = { INPUT_PIN_TABLE(INPUT_PIN_ROW) };
+
+#define NUM_INPUT_PINS  (sizeof(s_inputPinTable) / sizeof(s_inputPinTable[0]))
+
+/* Debouncing and gestures run off of a single compare channel of TIMER_A1,
+ * which counts continuously on ACLK / 4 (REFO, 8192 Hz) and wraps around every
+ * eight seconds. A deadline must therefore be less than half of that away. */
+#define INPUT_TIMER                 TIMER_A1_BASE
+#define INPUT_TIMER_CHANNEL         TIMER_A_CAPTURECOMPARE_REGISTER_1
+#define INPUT_TIMER_HZ              (8192)
+
+/* A compare value only fires when the counter reaches it, so never program one
+ * which the counter might already have passed by the time it is written. */
+#define INPUT_TIMER_MIN_TICKS       (2)
+
+/* Software timers run off of a second compare channel of the same timer. A
+ * deadline further away than SOFT_TIMER_MAX_TICKS (four seconds) is reached in
+ * several steps, so that the compare never has to look past half a wrap. */
+#define SOFT_TIMER_CHANNEL          TIMER_A_CAPTURECOMPARE_REGISTER_2
+#define SOFT_TIMER_MAX_TICKS        (INPUT_TIMER_HZ * 4)
+#define SOFT_TIMER_MAX_CYCLES                                                  \
+    ((uint64_t) SOFT_TIMER_MAX_TICKS * CYCLES_PER_SECOND / INPUT_TIMER_HZ)
+
+/* While software timers are running, the processor may still sleep in LPM3,
+ * where TIMER_A1 stops, until shortly before the earliest deadline. It is woken
+ * up by the interval interrupt of the RTC's second prescaler, which counts at
+ * 128 Hz and can interrupt every 2, 4, ... 256 of its ticks (1/64 s to 2 s).
+ * Deadlines closer than the shortest interval are left to TIMER_A1 in LPM0. */
+#define RTC_WAKEUP_HZ               (128)
+#define NUM_RTC_WAKEUPS             (8)
+#define RTC_WAKEUP_CYCLES(index)                                               \
+    ((uint64_t) (2u << (index)) * CYCLES_PER_SECOND / RTC_WAKEUP_HZ)
+
+/* Converts milliseconds into TIMER_A1 ticks and into [Clock_now()] cycles. */
+#define MS_TO_TICKS(ms)                                                        \
+    (((ms) * INPUT_TIMER_HZ) / MS_DIVISION_FACTOR)
+#define MS_TO_CYCLES(ms)            ((uint64_t) (ms) * CLOCK_TICKS_PER_MS)
+
+/* The number of [Clock_now()] cycles in one second. */
+#define CYCLES_PER_SECOND           (CLOCK_TICKS_PER_SECOND)
+
+/* Default supply currents for [PowerModel], in nanoamps. These are ballpark
+ * MSP432P401R datasheet figures at 3 MHz on the LDO, with the RTC running in
+ * LPM3. */
+#define DEFAULT_ACTIVE_NA           (700000)
+#define DEFAULT_LPM0_NA             (450000)
+#define DEFAULT_LPM3_NA             (850)
+#define DEFAULT_LPM4_NA             (500)
+
+/* NVIC interrupt numbers start at 16, after the Cortex-M4 system exceptions. */
+#define NVIC_BIT(interrupt)         (1u << (((interrupt) - 16) % 32))
+#define NVIC_WORD(interrupt)        (((interrupt) - 16) / 32)
+#define NUM_NVIC_WORDS              (2)
+
+/* The gestures which need the button to be timed while it is held down. */
+#define HELD_GESTURES                                                          \
+    (GESTURE_BIT(GESTURE_LONG_PRESS) | GESTURE_BIT(GESTURE_REPEAT))
+
+/** A one-shot deadline on TIMER_A1. */
+struct _Deadline
+{
+    uint16_t at;            // The TIMER_A1 count at which the deadline is due
+    bool armed;             // Whether the deadline is waiting to be due
+};
+typedef struct _Deadline Deadline;
+
+/**
+ * Debounce and gesture state for one row of [INPUT_PIN_TABLE()]. While
+ * [settle] is armed, the pin's interrupt is disabled and bounces on it cost
+ * nothing. Once it is due, the pin is sampled and its interrupt re-enabled,
+ * waiting for the release edge if the pin is still pressed and for the press
+ * edge otherwise. While the button is held, [gesture] times the next long
+ * press or auto-repeat, so that no one has to poll the button.
+ */
+struct _InputState
+{
+    Deadline settle;        // When to sample the pin after an edge
+    Deadline gesture;       // When the next long press or repeat is due
+    uint16_t debounceTicks; // How long the pin must settle, in TIMER_A1 ticks
+
+    bool down;              // Whether the button is pressed, once debounced
+    bool held;              // Whether the current press became a long press
+    bool secondTap;         // Whether the current press was a double tap
+    bool canDoubleTap;      // Whether the next press may be a double tap
+    uint64_t lastRelease;   // When the button was last released
+};
+typedef struct _InputState InputState;
+
+/**
+ * The policy of one event source, along with what the ISRs need to enforce it.
+ * [window] is the policy's limit converted to cycles ahead of time, so that
+ * coalescing does not need a 64-bit multiplication in the ISR.
+ */
+struct _EventSource
+{
+    EventPolicy policy;
+    EventPolicyStats stats;
+    uint64_t window;
+
+    /* Set by [InterruptHal_HandleInIsr()], in which case the policy is not
+     * enforced and nothing is queued for this source. */
+    IsrEventHandler isrHandler;
+
+    /* EVENT_POLICY_RATE_LIMIT: when the current one-second window started, and
+     * how many records have been queued in it so far. */
+    uint64_t windowStart;
+    uint32_t windowCount;
+};
+typedef struct _EventSource EventSource;
 
 /******************************************************************************/
 /* INTERRUPT HAL STRUCT DEFINITION                                            */
@@ -41,16 +181,79 @@
  */
 struct _InterruptHAL
 {
-    /* Event flags which are written as [true] whenever a corresponding ISR
-     * occurs. When the main application goes to sleep, we must reset all of
-     * these variables so that we're ready to log more events from our ISRs
-     * again.
+    /* Event records which are pushed whenever a corresponding ISR occurs. The
+     * main application drains this queue after it wakes up. Unlike a single
+     * boolean per source, a queue keeps every occurrence of an event (even if
+     * the same button fires twice before the main loop runs) as well as the
+     * order in which events occurred.
      *
-     * TODO: You will most likely need to add more interrupt event flags as you
-     *       expand what ISRs you implement in your system.
+     * TODO: You will most likely need to add more event IDs in EventQueue.h as
+     *       you expand what ISRs you implement in your system.
      */
-    volatile bool L1Tapped;
-    volatile bool JSTapped;
+    EventQueue events;
+
+    /* One bit per event ID, set whenever the corresponding ISR logs an event.
+     * ISRs only ever SET bits, through the Cortex-M4 bit-band alias of this
+     * word, which turns each set into a single atomic store. The main loop
+     * snapshots and clears the whole word at once through
+     * [InterruptHal_TakeEvents()]. */
+    volatile uint32_t pendingEvents;
+
+    /* Sleep bookkeeping, maintained by [SleepProcessor()]. These are only ever
+     * written from the main loop, but they live here next to the queue so that
+     * we can report them alongside the queue's overflow counter. */
+    SleepStats sleepStats;
+
+    /* Always-on latency instrumentation. [lastIsrExit] is written by every ISR
+     * which logs events as it returns, and [lastWake] is written by
+     * [SleepProcessor()] once the main application is about to resume. */
+    LatencyHistogram latency[NUM_LATENCY_KINDS];
+    volatile uint64_t lastIsrExit;
+    uint64_t lastWake;
+
+    /* Which row of [INPUT_PIN_TABLE()] each pin of each interrupt port belongs
+     * to, as an event ID, or NO_INPUT_PIN if the pin is not in the table. The
+     * per-port ISR uses this to go from a PxIV value to an event ID in O(1). */
+    uint8_t inputPins[NUM_INPUT_PORTS][NUM_PINS_PER_PORT];
+
+    /* One input state per row of [INPUT_PIN_TABLE()], indexed by event ID.
+     * Pin event IDs come first in [EventId], so they double as row indices. */
+    InputState inputs[NUM_INPUT_PINS];
+
+    /* The policy of every event source, indexed by event ID. Written by the
+     * main application with interrupts masked, read by the ISRs. */
+    EventSource sources[NUM_EVENT_IDS];
+
+    /* Idle governor state. [inputTimerArmed] is kept up to date by
+     * [InputTimer_schedule()], and [deepSleepSafe] has a bit set for every
+     * interrupt, in the layout of the NVIC enable registers, which may stay
+     * enabled while the processor is in LPM3 or LPM4. */
+    SleepMode deepestSleep;
+    bool inputTimerArmed;
+    uint32_t deepSleepSafe[NUM_NVIC_WORDS];
+
+    /* Every running software timer, earliest deadline first. Changed by the
+     * main application with interrupts masked, and by the timer ISR. */
+    TimerHeap softTimers;
+
+    /* Whether [SleepProcessor()] sleeps with SLEEPONEXIT set in LPM0. ISRs
+     * clear SLEEPONEXIT again whenever the main application has to run. */
+    bool sleepOnExit;
+
+    /* Power-mode residency accounting. Sleep residencies are added by
+     * [SleepProcessor()], ISR times by [InterruptHal_LogIsrTime()] and handler
+     * times by [InterruptHal_LogHandled()]. Active time is whatever is left
+     * over, so it is only worked out when the stats are read. */
+    PowerModel powerModel;
+    PowerStats power;
+    uint64_t powerSince;
+
+    /* Total time spent in, and number of returns from, the ISRs which call
+     * [InterruptHal_LogIsrTime()]. While sleeping on exit, ISRs run in the
+     * middle of a sleep, and [SleepProcessor()] uses these to take them back
+     * out of it. */
+    volatile uint64_t isrTime;
+    volatile uint32_t isrExits;
 };
 typedef struct _InterruptHAL InterruptHAL;
 
@@ -63,14 +266,45 @@ static InterruptHAL s_hal;
 /******************************************************************************/
 /* STATIC FUNCTION HEADERS AND PREPROCESSOR MACROS                            */
 /******************************************************************************/
-#define DEBOUNCE_TIME_MS            (50)
+/* Event Logging ------------------------------------------------------------ */
+static void LogEvent(EventId id, Gesture gesture, uint64_t timestamp);
+static void LogGesture(uint8_t id, Gesture gesture, uint64_t timestamp);
+static void LogIsrExit(IsrSource isr, uint64_t entryTime);
+static void WakeOnExit(void);
 
 /* Interrupt Service Routines ----------------------------------------------- */
-/* TODO: You will most likely need to add more interrupt service routines as  */
-/*       you expand what hardware you need to use from the board.             */
+/* Every pin in [INPUT_PIN_TABLE()] is serviced by the ISR of its port, so no */
+/* new ISRs are needed for new buttons. Add ISRs here only for other hardware */
+/* you need to use from the board, such as timers.                            */
 /* -------------------------------------------------------------------------- */
-static void ISR_LaunchpadButtons(void);
-static void ISR_BoosterpackJS(void);
+static void ISR_InputPort(uint_fast8_t portIndex);
+static void ISR_Port1(void);
+static void ISR_Port2(void);
+static void ISR_Port3(void);
+static void ISR_Port4(void);
+static void ISR_Port5(void);
+static void ISR_Port6(void);
+static void ISR_InputTimer(void);
+static void ISR_RtcWakeup(void);
+
+/* Debouncing and Gestures -------------------------------------------------- */
+static bool IsPressed(const InputPin* input);
+static void Input_edge(uint8_t id, uint64_t timestamp);
+static void Input_settle(uint8_t id, uint64_t timestamp);
+static void Input_transition(uint8_t id, bool down, uint64_t timestamp);
+static void Input_gesture(uint8_t id, uint64_t timestamp);
+static void Deadline_arm(Deadline* deadline, uint16_t ticks);
+static bool Deadline_due(const Deadline* deadline, uint16_t ticks);
+static void InputTimer_schedule(void);
+
+/* Software Timers ---------------------------------------------------------- */
+static void SoftTimers_expire(uint64_t timestamp);
+static void SoftTimers_schedule(void);
+
+/* Idle Governor ------------------------------------------------------------ */
+static SleepMode ChooseSleepMode(void);
+static SleepMode EnterSleepMode(SleepMode mode);
+static int RtcWakeup_choose(void);
 
 /* Initialization Functions ------------------------------------------------- */
 /* TODO: You will most likely need to add more initialization functions as    */
@@ -78,96 +312,684 @@ static void ISR_BoosterpackJS(void);
 /* -------------------------------------------------------------------------- */
 static void Init_HALVariables(void);
 static void Init_LaunchpadLEDs(void);
-static void Init_LaunchpadButtons(void);
+static void Init_InputPins(void);
+static void Init_InputTimer(void);
+static void Init_RtcWakeup(void);
+
+/******************************************************************************/
+/* EVENT LOGGING                                                              */
+/******************************************************************************/
+
+/**
+ * Logs an event from an ISR. First, the source's policy may merge the event
+ * into a record which is already queued, or drop it. Either way, the pending
+ * bit is left alone, so the main application is not woken up for it - a merged
+ * record is already going to be handed over.
+ *
+ * Otherwise, the record is queued first and the pending bit is set second, so
+ * that by the time the main loop sees the bit, the record it stands for is
+ * already in the queue. The bit is set even if the queue was full and the
+ * record was dropped - the source DID fire.
+ *
+ * @param id:           The ID of the event to log
+ * @param gesture:      What the button did, or GESTURE_NONE for non-buttons
+ * @param timestamp:    When the event occurred, from [Clock_now()]
+ */
+static void LogEvent(EventId id, Gesture gesture, uint64_t timestamp)
+{
+    EventSource* source = &s_hal.sources[id];
+    Event event = { id, gesture, 1, timestamp };
+
+    if (source->isrHandler != NULL)
+    {
+        uint64_t start = Clock_now();
+        source->isrHandler(&event);
+        s_hal.power.handler[id] += Clock_now() - start;
+        return;
+    }
+
+    switch (source->policy.kind)
+    {
+        case EVENT_POLICY_COALESCE:
+            if (EventQueue_coalesce(&s_hal.events, event, source->window))
+            {
+                source->stats.merged++;
+                return;
+            }
+            break;
+
+        case EVENT_POLICY_KEEP_LATEST:
+            if (EventQueue_replace(&s_hal.events, event))
+            {
+                source->stats.merged++;
+                return;
+            }
+            break;
+
+        case EVENT_POLICY_RATE_LIMIT:
+            if (timestamp - source->windowStart >= CYCLES_PER_SECOND)
+            {
+                source->windowStart = timestamp;
+                source->windowCount = 0;
+            }
+
+            if (source->windowCount >= source->policy.limit)
+            {
+                source->stats.dropped++;
+                return;
+            }
+
+            source->windowCount++;
+            break;
+
+        default:
+            break;
+    }
+
+    EventQueue_push(&s_hal.events, event);
+
+    BITBAND_SRAM(s_hal.pendingEvents, id) = 1;
+    WakeOnExit();
+}
+
+/**
+ * Makes sure the processor returns to the main application when the current
+ * ISR returns, rather than going back to sleep.
+ */
+static void WakeOnExit(void)
+{
+    if (s_hal.sleepOnExit)
+        Interrupt_disableSleepOnIsrExit();
+}
+
+/**
+ * Logs a gesture of an input pin, but only if its row of [INPUT_PIN_TABLE()]
+ * asked for that gesture.
+ *
+ * @param id:           The event ID (and table row) of the pin
+ * @param gesture:      The gesture which was recognized
+ * @param timestamp:    When the gesture occurred, from [Clock_now()]
+ */
+static void LogGesture(uint8_t id, Gesture gesture, uint64_t timestamp)
+{
+    if (s_inputPinTable[id].gestures & GESTURE_BIT(gesture))
+        LogEvent((EventId) id, gesture, timestamp);
+}
+
+/**
+ * Records how long an ISR took to run, both in the latency histogram and in the
+ * ISR's power accounting, then remembers when it returned so that
+ * [SleepProcessor()] can measure how long the main application took to resume.
+ * Call this as the very last thing in every ISR which logs events.
+ *
+ * @param isr:          Which ISR is returning
+ * @param entryTime:    When the ISR was entered, from [Clock_now()]
+ */
+static void LogIsrExit(IsrSource isr, uint64_t entryTime)
+{
+    uint64_t now = Clock_now();
+
+    LatencyHistogram_record(&s_hal.latency[LATENCY_ISR], now - entryTime);
+    InterruptHal_LogIsrTime(isr, entryTime);
+    s_hal.lastIsrExit = now;
+}
 
 /******************************************************************************/
 /* INTERRUPT SERVICE ROUTINES (ISRS)                                          */
 /******************************************************************************/
 
+/* The interrupt vector register of each port, its NVIC interrupt number and
+ * its ISR, indexed by [PORT_INDEX()]. */
+static volatile const uint16_t* const s_portVectors[NUM_INPUT_PORTS] =
+{
+    &P1->IV, &P2->IV, &P3->IV, &P4->IV, &P5->IV, &P6->IV
+};
+
+static const uint32_t s_portInterrupts[NUM_INPUT_PORTS] =
+{
+    INT_PORT1, INT_PORT2, INT_PORT3, INT_PORT4, INT_PORT5, INT_PORT6
+};
+
+static void (* const s_portIsrs[NUM_INPUT_PORTS])(void) =
+{
+    ISR_Port1, ISR_Port2, ISR_Port3, ISR_Port4, ISR_Port5, ISR_Port6
+};
+
 /**
- * Automatically invoked by the MSP432's interrupt controller whenever any
- * input pin on GPIO_PORT1 triggers an interrupt event. Do not call this
- * function manually.
+ * The shared ISR for every pin in [INPUT_PIN_TABLE()]. Rather than reading the
+ * whole interrupt flag register and testing each pin we care about, we read
+ * the port's PxIV register. Each read returns the highest priority pending pin
+ * as (2 * pin + 2), or 0 once no pins are pending, and clears that pin's flag
+ * for us. The pin number then indexes straight into [s_hal.inputPins].
+ *
+ * @param portIndex:    The [PORT_INDEX()] of the port which interrupted
  */
-static void ISR_LaunchpadButtons(void)
+static void ISR_InputPort(uint_fast8_t portIndex)
 {
-    /* Debounce state variables and first-call initialization. Note - the     */
-    /* SWTimer module has been updated as of March 30, 2021 so that           */
-    /* SWTimer_construct() returns timers which are already expired. As a     */
-    /* direct result, when this function is first called (probably when       */
-    /* pressing L1 for the first time after reset), the if-statement which    */
-    /* checks if the timer expired evaluates as TRUE, allowing the button     */
-    /* event to be logged even on the first trigger of this ISR.              */
+    /* Timestamp the edge before doing anything else, so that handlers in     */
+    /* the main application know when it actually happened.                   */
     /* ---------------------------------------------------------------------- */
-    static SWTimer debounceL1;
-    static bool firstCall = true;
+    uint64_t now = Clock_now();
+    PROFILE_BEGIN(PROFILE_GPIO_ISR);
 
-    if (firstCall)
+    uint_fast16_t vector;
+    while ((vector = *s_portVectors[portIndex]) != 0)
     {
-        debounceL1 = SWTimer_construct(DEBOUNCE_TIME_MS);
-        firstCall = false;
+        uint8_t id = s_hal.inputPins[portIndex][(vector >> 1) - 1];
+
+        if (id != NO_INPUT_PIN)
+            Input_edge(id, now);
     }
 
-    /* First, determine which pins triggered this ISR. Different pins may     */
-    /* require different system responses from your ISR.                      */
-    /* ---------------------------------------------------------------------- */
-    uint32_t status = GPIO_getEnabledInterruptStatus(GPIO_PORT_P1);
+    PROFILE_END(PROFILE_GPIO_ISR);
+    LogIsrExit((IsrSource) (ISR_SOURCE_PORT1 + portIndex), now);
+}
+
+/**
+ * Automatically invoked by the MSP432's interrupt controller whenever an input
+ * pin on the corresponding port triggers an interrupt event. Do not call these
+ * functions manually.
+ */
+static void ISR_Port1(void) { ISR_InputPort(PORT_INDEX(GPIO_PORT_P1)); }
+static void ISR_Port2(void) { ISR_InputPort(PORT_INDEX(GPIO_PORT_P2)); }
+static void ISR_Port3(void) { ISR_InputPort(PORT_INDEX(GPIO_PORT_P3)); }
+static void ISR_Port4(void) { ISR_InputPort(PORT_INDEX(GPIO_PORT_P4)); }
+static void ISR_Port5(void) { ISR_InputPort(PORT_INDEX(GPIO_PORT_P5)); }
+static void ISR_Port6(void) { ISR_InputPort(PORT_INDEX(GPIO_PORT_P6)); }
+
+/**
+ * Automatically invoked by the MSP432's interrupt controller whenever one of
+ * the compare channels of TIMER_A1 fires. The input channel handles every
+ * settle and gesture deadline which is due, then arms itself for the next
+ * deadline. The software timer channel does the same for software timers. Do
+ * not call this function manually.
+ */
+static void ISR_InputTimer(void)
+{
+    uint64_t now = Clock_now();
 
-    /* Check if L1 (Port 1, Pin 1) generated this ISR. */
-    if ((status & GPIO_PIN1) == GPIO_PIN1)
+    if (Timer_A_getCaptureCompareEnabledInterruptStatus(INPUT_TIMER,
+            INPUT_TIMER_CHANNEL, TIMER_A_CAPTURECOMPARE_INTERRUPT_FLAG))
     {
-        /* Log the event using the L1Tapped flag if the debouncer has expired */
-        if (SWTimer_expired(&debounceL1))
+        Timer_A_clearCaptureCompareInterrupt(INPUT_TIMER, INPUT_TIMER_CHANNEL);
+        uint16_t ticks = Timer_A_getCounterValue(INPUT_TIMER);
+
+        unsigned int id;
+        for (id = 0; id < NUM_INPUT_PINS; id++)
         {
-            s_hal.L1Tapped = true;
+            InputState* state = &s_hal.inputs[id];
+
+            if (Deadline_due(&state->settle, ticks))
+            {
+                state->settle.armed = false;
+                Input_settle(id, now);
+            }
 
-            /* Restart this timer so that if the interrupt triggers again too */
-            /* soon after this call, we ignore it until the timer expires.    */
-            SWTimer_start(&debounceL1);
+            if (Deadline_due(&state->gesture, ticks))
+            {
+                state->gesture.armed = false;
+                Input_gesture(id, now);
+            }
         }
+
+        InputTimer_schedule();
+    }
+
+    if (Timer_A_getCaptureCompareEnabledInterruptStatus(INPUT_TIMER,
+            SOFT_TIMER_CHANNEL, TIMER_A_CAPTURECOMPARE_INTERRUPT_FLAG))
+    {
+        Timer_A_clearCaptureCompareInterrupt(INPUT_TIMER, SOFT_TIMER_CHANNEL);
+        SoftTimers_expire(now);
     }
 
-    /* After servicing an interrupt, clear appropriate interrupt flags. */
-    GPIO_clearInterruptFlag(GPIO_PORT_P1, GPIO_PIN1);
+    LogIsrExit(ISR_SOURCE_INPUT_TIMER, now);
 }
 
 /**
- * Automatically invoked by the MSP432's interrupt controller whenever any input
- * pin on GPIO_PORT4 triggers an interrupt event, namely the Boosterpack
- * joystick button. Do not call this function manually.
+ * Automatically invoked by the MSP432's interrupt controller when the RTC wakes
+ * the processor up from LPM3 for a software timer. By the time this runs,
+ * [EnterSleepMode()] has already caught up with the time slept and handed the
+ * timers back to TIMER_A1, so all that is left is to clear the flag. Do not
+ * call this function manually.
  */
-static void ISR_BoosterpackJS(void)
+static void ISR_RtcWakeup(void)
 {
-    /* We use the same debouncing technique as before to debounce this ISR. */
-    static SWTimer debounceJS;
-    static bool firstCall = true;
+    RTC_C_clearInterruptFlag(RTC_C_PRESCALE_TIMER1_INTERRUPT);
+}
 
-    if (firstCall)
+/******************************************************************************/
+/* DEBOUNCING AND GESTURES                                                    */
+/******************************************************************************/
+
+/** Returns whether an input pin is currently at its pressed (active) level. */
+static bool IsPressed(const InputPin* input)
+{
+    uint_fast8_t activeLevel =
+        (input->edge == GPIO_HIGH_TO_LOW_TRANSITION)
+            ? GPIO_INPUT_PIN_LOW : GPIO_INPUT_PIN_HIGH;
+
+    return GPIO_getInputPinValue(input->port, input->pin) == activeLevel;
+}
+
+/**
+ * Handles the first edge of a pin after it has settled. The press or release
+ * is handled right away, so debouncing adds no latency. Either way, the pin's
+ * interrupt is disabled until its debounce time has passed, so any bounces
+ * which follow never reach an ISR at all.
+ *
+ * @param id:           The event ID (and table row) of the pin which fired
+ * @param timestamp:    When the edge occurred, from [Clock_now()]
+ */
+static void Input_edge(uint8_t id, uint64_t timestamp)
+{
+    const InputPin* input = &s_inputPinTable[id];
+    InputState* state = &s_hal.inputs[id];
+
+    GPIO_disableInterrupt(input->port, input->pin);
+
+    Input_transition(id, !state->down, timestamp);
+
+    Deadline_arm(&state->settle, state->debounceTicks);
+    InputTimer_schedule();
+}
+
+/**
+ * Samples a pin once its debounce time has passed and re-enables its interrupt
+ * on whichever edge comes next. If the pin is no longer where its last edge
+ * left it, it moved back while its interrupt was disabled, so we handle that
+ * transition here and let it settle again. If the pin moves while we are
+ * setting up the interrupt, that edge may have been missed, so we handle it
+ * right here as well.
+ *
+ * @param id:           The event ID (and table row) of the pin to sample
+ * @param timestamp:    When the debounce time passed, from [Clock_now()]
+ */
+static void Input_settle(uint8_t id, uint64_t timestamp)
+{
+    const InputPin* input = &s_inputPinTable[id];
+    InputState* state = &s_hal.inputs[id];
+
+    bool pressed = IsPressed(input);
+    if (pressed != state->down)
+    {
+        Input_transition(id, pressed, timestamp);
+        Deadline_arm(&state->settle, state->debounceTicks);
+        return;
+    }
+
+    uint_fast8_t releaseEdge =
+        (input->edge == GPIO_HIGH_TO_LOW_TRANSITION)
+            ? GPIO_LOW_TO_HIGH_TRANSITION : GPIO_HIGH_TO_LOW_TRANSITION;
+
+    GPIO_interruptEdgeSelect(
+        input->port, input->pin, pressed ? releaseEdge : input->edge);
+    GPIO_clearInterruptFlag(input->port, input->pin);
+    GPIO_enableInterrupt(input->port, input->pin);
+
+    if (IsPressed(input) != pressed)
+        Input_edge(id, Clock_now());
+}
+
+/**
+ * Runs the gesture recognizer for a debounced press or release. A press logs
+ * GESTURE_PRESS, then GESTURE_DOUBLE_TAP if it came soon enough after a plain
+ * tap, and starts timing the long press. A release logs GESTURE_RELEASE and
+ * stops timing. Long presses and double taps do not count as the first tap of
+ * another double tap.
+ *
+ * @param id:           The event ID (and table row) of the pin
+ * @param down:         Whether the button went down (true) or up (false)
+ * @param timestamp:    When the transition occurred, from [Clock_now()]
+ */
+static void Input_transition(uint8_t id, bool down, uint64_t timestamp)
+{
+    InputState* state = &s_hal.inputs[id];
+
+    state->down = down;
+
+    if (down)
+    {
+        LogGesture(id, GESTURE_PRESS, timestamp);
+
+        state->secondTap = state->canDoubleTap
+            && (timestamp - state->lastRelease
+                <= MS_TO_CYCLES(GESTURE_DOUBLE_TAP_MS));
+
+        if (state->secondTap)
+            LogGesture(id, GESTURE_DOUBLE_TAP, timestamp);
+
+        state->held = false;
+
+        if (s_inputPinTable[id].gestures & HELD_GESTURES)
+            Deadline_arm(&state->gesture, MS_TO_TICKS(GESTURE_LONG_PRESS_MS));
+    }
+    else
+    {
+        LogGesture(id, GESTURE_RELEASE, timestamp);
+
+        state->gesture.armed = false;
+        state->canDoubleTap = !state->held && !state->secondTap;
+        state->lastRelease = timestamp;
+    }
+}
+
+/**
+ * Called when a button has been held until its gesture deadline. The first
+ * time, that is a long press. After that, if the pin asked for auto-repeat,
+ * the deadline is pushed back by GESTURE_REPEAT_MS from when it was due (not
+ * from now), so that repeats do not drift.
+ *
+ * @param id:           The event ID (and table row) of the pin
+ * @param timestamp:    When the deadline was handled, from [Clock_now()]
+ */
+static void Input_gesture(uint8_t id, uint64_t timestamp)
+{
+    InputState* state = &s_hal.inputs[id];
+
+    LogGesture(id, state->held ? GESTURE_REPEAT : GESTURE_LONG_PRESS,
+               timestamp);
+    state->held = true;
+
+    if (s_inputPinTable[id].gestures & GESTURE_BIT(GESTURE_REPEAT))
+    {
+        state->gesture.at += MS_TO_TICKS(GESTURE_REPEAT_MS);
+        state->gesture.armed = true;
+    }
+}
+
+/** Arms a deadline to be due [ticks] TIMER_A1 ticks from now. */
+static void Deadline_arm(Deadline* deadline, uint16_t ticks)
+{
+    deadline->at = Timer_A_getCounterValue(INPUT_TIMER) + ticks;
+    deadline->armed = true;
+}
+
+/** Returns whether a deadline is armed and due at TIMER_A1 count [ticks]. */
+static bool Deadline_due(const Deadline* deadline, uint16_t ticks)
+{
+    return deadline->armed && (int16_t) (deadline->at - ticks) <= 0;
+}
+
+/**
+ * Programs the TIMER_A1 compare channel for the earliest armed deadline, or
+ * turns it off if no deadline is armed. Deadlines which are (nearly) due
+ * already are pushed out by a couple of ticks so that they cannot be missed.
+ */
+static void InputTimer_schedule(void)
+{
+    uint16_t ticks = Timer_A_getCounterValue(INPUT_TIMER);
+    bool anyArmed = false;
+    int16_t soonest = 0;
+
+    unsigned int id;
+    for (id = 0; id < NUM_INPUT_PINS; id++)
     {
-        debounceJS = SWTimer_construct(DEBOUNCE_TIME_MS);
-        firstCall = false;
+        const Deadline* deadlines[] =
+            { &s_hal.inputs[id].settle, &s_hal.inputs[id].gesture };
+
+        int i;
+        for (i = 0; i < 2; i++)
+        {
+            int16_t remaining = (int16_t) (deadlines[i]->at - ticks);
+
+            if (deadlines[i]->armed && (!anyArmed || remaining < soonest))
+            {
+                soonest = remaining;
+                anyArmed = true;
+            }
+        }
     }
 
-    uint32_t status = GPIO_getEnabledInterruptStatus(GPIO_PORT_P4);
+    s_hal.inputTimerArmed = anyArmed;
+
+    if (!anyArmed)
+    {
+        Timer_A_disableCaptureCompareInterrupt(
+            INPUT_TIMER, INPUT_TIMER_CHANNEL);
+
+        /* The last deadline kept us in LPM0. Let the governor look again. */
+        if (s_hal.deepestSleep != SLEEP_MODE_LPM0)
+            WakeOnExit();
+
+        return;
+    }
+
+    if (soonest < INPUT_TIMER_MIN_TICKS)
+        soonest = INPUT_TIMER_MIN_TICKS;
+
+    Timer_A_setCompareValue(
+        INPUT_TIMER, INPUT_TIMER_CHANNEL, (uint16_t) (ticks + soonest));
+    Timer_A_clearCaptureCompareInterrupt(INPUT_TIMER, INPUT_TIMER_CHANNEL);
+    Timer_A_enableCaptureCompareInterrupt(INPUT_TIMER, INPUT_TIMER_CHANNEL);
+}
+
+/******************************************************************************/
+/* SOFTWARE TIMERS                                                            */
+/******************************************************************************/
 
-    /* Check if the joystick button (Port 4, Pin 1) generated this ISR */
-    if ((status & GPIO_PIN1) == GPIO_PIN1)
+/**
+ * Services every software timer which is due. Each periodic timer goes back
+ * into the heap at its previous deadline plus its period, skipping any whole
+ * periods which have already passed, before its callback runs or its event is
+ * logged. One-shot timers are out of the heap by then, so either kind may be
+ * restarted or cancelled from its own callback.
+ *
+ * @param timestamp:    When the timer ISR was entered, from [Clock_now()]
+ */
+static void SoftTimers_expire(uint64_t timestamp)
+{
+    SoftTimer* timer;
+
+    while (((timer = TimerHeap_peek(&s_hal.softTimers)) != NULL)
+        && (timer->deadline <= timestamp))
     {
-        /* Log the event using the JSTapped flag if the debouncer has expired */
-        if (SWTimer_expired(&debounceJS))
+        TimerHeap_remove(&s_hal.softTimers, timer);
+
+        if (timer->period != 0)
         {
-            s_hal.JSTapped = true;
+            do
+            {
+                timer->deadline += timer->period;
+            } while (timer->deadline <= timestamp);
 
-            /* Restart this timer so that if the interrupt triggers again too */
-            /* soon after this call, we ignore it until the timer expires.    */
-            SWTimer_start(&debounceJS);
+            TimerHeap_insert(&s_hal.softTimers, timer);
         }
+
+        if (timer->callback != NULL)
+            timer->callback(timer);
+        else
+            LogEvent(timer->id, GESTURE_NONE, timestamp);
+    }
+
+    SoftTimers_schedule();
+}
+
+/**
+ * Programs the software timer compare channel for the earliest deadline, or
+ * turns it off if no timer is running. The compare is rounded up to the next
+ * TIMER_A1 tick, so it never fires before the deadline, but if it fires a
+ * little early anyway because ACLK and MCLK disagree, [SoftTimers_expire()]
+ * finds nothing due and simply programs it again.
+ */
+static void SoftTimers_schedule(void)
+{
+    SoftTimer* next = TimerHeap_peek(&s_hal.softTimers);
+
+    if (next == NULL)
+    {
+        Timer_A_disableCaptureCompareInterrupt(INPUT_TIMER, SOFT_TIMER_CHANNEL);
+
+        /* The last timer kept us in LPM0. Let the governor look again. */
+        if (s_hal.deepestSleep != SLEEP_MODE_LPM0)
+            WakeOnExit();
+
+        return;
+    }
+
+    uint64_t now = Clock_now();
+    uint64_t remaining = (next->deadline > now) ? next->deadline - now : 0;
+
+    if (remaining > SOFT_TIMER_MAX_CYCLES)
+        remaining = SOFT_TIMER_MAX_CYCLES;
+
+    uint32_t ticks = (uint32_t)
+        ((remaining * INPUT_TIMER_HZ + CYCLES_PER_SECOND - 1)
+            / CYCLES_PER_SECOND);
+
+    if (ticks < INPUT_TIMER_MIN_TICKS)
+        ticks = INPUT_TIMER_MIN_TICKS;
+
+    uint16_t counter = Timer_A_getCounterValue(INPUT_TIMER);
+    Timer_A_setCompareValue(
+        INPUT_TIMER, SOFT_TIMER_CHANNEL, (uint16_t) (counter + ticks));
+    Timer_A_clearCaptureCompareInterrupt(INPUT_TIMER, SOFT_TIMER_CHANNEL);
+    Timer_A_enableCaptureCompareInterrupt(INPUT_TIMER, SOFT_TIMER_CHANNEL);
+}
+
+/******************************************************************************/
+/* IDLE GOVERNOR                                                              */
+/******************************************************************************/
+
+/* Interrupts which can stay enabled in deep sleep. GPIO ports wake the
+ * processor from LPM3 and LPM4 and the RTC from LPM3. TIMER32_0 stops in deep
+ * sleep, but only keeps time, which [Clock_resume()] makes up for. TIMER_A1
+ * stops as well, but only while no input deadline is armed, and the RTC stands
+ * in for it while software timers are running. */
+static const uint32_t s_deepSleepWakeSources[] =
+{
+    INT_PORT1, INT_PORT2, INT_PORT3, INT_PORT4, INT_PORT5, INT_PORT6,
+    INT_RTC_C, INT_T32_INT1, INT_TA1_N
+};
+
+/* The RTC prescale event dividers which give each wakeup interval, shortest
+ * first. */
+static const uint_fast8_t s_rtcWakeupDividers[NUM_RTC_WAKEUPS] =
+{
+    RTC_C_PSEVENTDIVIDER_2,  RTC_C_PSEVENTDIVIDER_4,
+    RTC_C_PSEVENTDIVIDER_8,  RTC_C_PSEVENTDIVIDER_16,
+    RTC_C_PSEVENTDIVIDER_32, RTC_C_PSEVENTDIVIDER_64,
+    RTC_C_PSEVENTDIVIDER_128, RTC_C_PSEVENTDIVIDER_256
+};
+
+/**
+ * Picks the deepest low-power mode the system can sleep in right now. An armed
+ * debounce or gesture deadline needs TIMER_A1 to keep counting, which it only
+ * does in LPM0, and so does a software timer which is due sooner than the RTC
+ * can wake us up. Any enabled interrupt which is not known to be safe in deep
+ * sleep may belong to a peripheral which needs MCLK or SMCLK, so it keeps us in
+ * LPM0 as well. Otherwise, we go as deep as [InterruptHal_SetDeepestSleep()]
+ * allows, but no deeper than LPM3 while software timers are running, since the
+ * RTC stops in LPM4.
+ */
+static SleepMode ChooseSleepMode(void)
+{
+    bool timersRunning = TimerHeap_peek(&s_hal.softTimers) != NULL;
+
+    if (s_hal.inputTimerArmed || (timersRunning && RtcWakeup_choose() < 0))
+        return SLEEP_MODE_LPM0;
+
+    int i;
+    for (i = 0; i < NUM_NVIC_WORDS; i++)
+    {
+        if (NVIC->ISER[i] & ~s_hal.deepSleepSafe[i])
+            return SLEEP_MODE_LPM0;
     }
 
-    /* After servicing an interrupt, clear appropriate interrupt flags. */
-    GPIO_clearInterruptFlag(GPIO_PORT_P4, GPIO_PIN1);
+    if (timersRunning && s_hal.deepestSleep > SLEEP_MODE_LPM3)
+        return SLEEP_MODE_LPM3;
+
+    return s_hal.deepestSleep;
+}
+
+/**
+ * Picks the longest RTC wakeup interval which ends no later than the earliest
+ * software timer deadline. The first wakeup comes at the next multiple of the
+ * interval, which is never further away than the interval itself, so the
+ * processor always wakes up in time and then sleeps again for whatever is left.
+ *
+ * @return an index into [s_rtcWakeupDividers], or -1 if there is no timer
+ *         running or the earliest deadline is closer than the shortest interval
+ */
+static int RtcWakeup_choose(void)
+{
+    SoftTimer* next = TimerHeap_peek(&s_hal.softTimers);
+    if (next == NULL)
+        return -1;
+
+    uint64_t now = Clock_now();
+    uint64_t remaining = (next->deadline > now) ? next->deadline - now : 0;
+
+    int index = NUM_RTC_WAKEUPS - 1;
+    while ((index >= 0) && (RTC_WAKEUP_CYCLES(index) > remaining))
+        index--;
+
+    return index;
 }
 
+/**
+ * Sleeps in the given low-power mode until an interrupt is pending. Call this
+ * with interrupts masked. Before deep sleep, TIMER_A1 is stopped, since a
+ * running timer requests a clock which LPM3 does not provide, and timekeeping
+ * is handed over to the RTC, which also wakes us up in time for the earliest
+ * software timer. After waking up, the time slept is added back to
+ * [Clock_now()] before any ISR gets to timestamp anything, and the software
+ * timers are handed back to TIMER_A1, whose counter missed the time slept. If
+ * the processor refuses to enter deep sleep, we fall back to LPM0 instead of
+ * spinning.
+ *
+ * @param mode:     The low-power mode to sleep in
+ * @return the low-power mode the processor actually slept in
+ */
+static SleepMode EnterSleepMode(SleepMode mode)
+{
+    if (mode == SLEEP_MODE_LPM0)
+    {
+        PCM_gotoLPM0();
+        return SLEEP_MODE_LPM0;
+    }
+
+    s_hal.sleepStats.deepSleeps++;
+
+    int wakeup = RtcWakeup_choose();
+    if (wakeup >= 0)
+    {
+        RTC_C_definePrescaleEvent(RTC_C_PRESCALE_1,
+                                  s_rtcWakeupDividers[wakeup]);
+        RTC_C_clearInterruptFlag(RTC_C_PRESCALE_TIMER1_INTERRUPT);
+        RTC_C_enableInterrupt(RTC_C_PRESCALE_TIMER1_INTERRUPT);
+    }
+
+    Timer_A_stopTimer(INPUT_TIMER);
+    Clock_suspend();
+
+    bool slept = (mode == SLEEP_MODE_LPM4) ? PCM_gotoLPM4() : PCM_gotoLPM3();
+
+    /* PCM_gotoLPM4() holds the RTC so that it stops as well. */
+    if (mode == SLEEP_MODE_LPM4)
+        RTC_C_startClock();
+
+    Clock_resume();
+    Timer_A_startCounter(INPUT_TIMER, TIMER_A_CONTINUOUS_MODE);
+
+    if (wakeup >= 0)
+    {
+        RTC_C_disableInterrupt(RTC_C_PRESCALE_TIMER1_INTERRUPT);
+        SoftTimers_schedule();
+    }
+
+    if (!slept)
+    {
+        PCM_gotoLPM0();
+        return SLEEP_MODE_LPM0;
+    }
+
+    return mode;
+}
+
+/******************************************************************************/
+/* INITIALIZATION                                                             */
+/******************************************************************************/
+
 /**
  * Initializes the variables inside of the HAL struct.
  *
@@ -176,8 +998,56 @@ static void ISR_BoosterpackJS(void)
  */
 static void Init_HALVariables()
 {
-    s_hal.JSTapped = false;
-    s_hal.L1Tapped = false;
+    EventQueue_init(&s_hal.events);
+    s_hal.pendingEvents = 0;
+
+    s_hal.sleepStats.sleeps = 0;
+    s_hal.sleepStats.deepSleeps = 0;
+    s_hal.sleepStats.emptyWakeups = 0;
+    s_hal.sleepStats.skippedSleeps = 0;
+
+    InterruptHal_ResetLatency();
+    s_hal.lastIsrExit = 0;
+    s_hal.lastWake = 0;
+
+    EventPolicy keepAll = { EVENT_POLICY_KEEP_ALL, 0 };
+
+    int id;
+    for (id = 0; id < NUM_EVENT_IDS; id++)
+    {
+        InterruptHal_SetEventPolicy((EventId) id, keepAll);
+        s_hal.sources[id].isrHandler = NULL;
+    }
+
+    s_hal.deepestSleep = SLEEP_MODE_LPM3;
+    s_hal.inputTimerArmed = false;
+    s_hal.sleepOnExit = false;
+    TimerHeap_init(&s_hal.softTimers);
+    s_hal.isrTime = 0;
+    s_hal.isrExits = 0;
+
+    PowerModel defaultModel =
+    {
+        DEFAULT_ACTIVE_NA,
+        { DEFAULT_LPM0_NA, DEFAULT_LPM3_NA, DEFAULT_LPM4_NA }
+    };
+    InterruptHal_SetPowerModel(defaultModel);
+    InterruptHal_ResetPowerStats();
+
+    unsigned int i;
+    for (i = 0; i < NUM_NVIC_WORDS; i++)
+        s_hal.deepSleepSafe[i] = 0;
+
+    for (i = 0; i < sizeof(s_deepSleepWakeSources) / sizeof(uint32_t); i++)
+    {
+        uint32_t interrupt = s_deepSleepWakeSources[i];
+        s_hal.deepSleepSafe[NVIC_WORD(interrupt)] |= NVIC_BIT(interrupt);
+    }
+
+    int port, pin;
+    for (port = 0; port < NUM_INPUT_PORTS; port++)
+        for (pin = 0; pin < NUM_PINS_PER_PORT; pin++)
+            s_hal.inputPins[port][pin] = NO_INPUT_PIN;
 }
 
 /**
@@ -196,47 +1066,112 @@ static void Init_LaunchpadLEDs(void)
 }
 
 /**
- * Initializes Launchpad S1 (L1) with interrupts enabled on a high-to-low
- * transition, or a falling edge.
+ * Initializes every pin in [INPUT_PIN_TABLE()] as an interrupt-enabled input,
+ * then registers and enables the ISR of every port which has at least one of
+ * those pins. Ports without any inputs in the table are left alone.
  *
- * TODO: Add Launchpad S2 (L2) initialization to this, and tweak or add to the
- *       ISRs to generate events upon pressing L2 as well.
+ * TODO: To add a button, add a row to [INPUT_PIN_TABLE()] in InputPins.h
+ *       instead of extending this function.
  */
-static void Init_LaunchpadButtons(void)
+static void Init_InputPins(void)
 {
-    /* Launchpad L1 (P1.1) is an input with a pull-up resistor required. */
-    GPIO_setAsInputPinWithPullUpResistor(GPIO_PORT_P1, GPIO_PIN1);
+    bool portUsed[NUM_INPUT_PORTS] = { false };
 
-    /* Enable interrupts for Launchpad L1 through GPIO Port 1 */
-    GPIO_clearInterruptFlag(GPIO_PORT_P1, GPIO_PIN1);
-    GPIO_enableInterrupt(GPIO_PORT_P1, GPIO_PIN1);
-    GPIO_registerInterrupt(GPIO_PORT_P1, ISR_LaunchpadButtons);
-    GPIO_interruptEdgeSelect(
-        GPIO_PORT_P1, GPIO_PIN1, GPIO_HIGH_TO_LOW_TRANSITION);
+    unsigned int i;
+    for (i = 0; i < NUM_INPUT_PINS; i++)
+    {
+        const InputPin* input = &s_inputPinTable[i];
+
+        switch (input->pull)
+        {
+            case INPUT_PULL_UP:
+                GPIO_setAsInputPinWithPullUpResistor(input->port, input->pin);
+                break;
 
-    /* Enables the interrupt for GPIO_PORT1 events. To determine what other
-     * events are available for configuration, CTRL+click on INT_PORT1. */
-    Interrupt_enableInterrupt(INT_PORT1);
+            case INPUT_PULL_DOWN:
+                GPIO_setAsInputPinWithPullDownResistor(input->port, input->pin);
+                break;
+
+            default:
+                GPIO_setAsInputPin(input->port, input->pin);
+                break;
+        }
+
+        /* Changing the edge can set the pin's flag, so select the edge before
+         * clearing the flag and enabling the interrupt. */
+        GPIO_interruptEdgeSelect(input->port, input->pin, input->edge);
+        GPIO_clearInterruptFlag(input->port, input->pin);
+        GPIO_enableInterrupt(input->port, input->pin);
+
+        s_hal.inputPins[PORT_INDEX(input->port)][31 - __CLZ(input->pin)] =
+            input->id;
+
+        InputState* state = &s_hal.inputs[input->id];
+        state->settle.armed = false;
+        state->gesture.armed = false;
+        state->debounceTicks = MS_TO_TICKS(input->debounceMs);
+        state->down = false;
+        state->held = false;
+        state->secondTap = false;
+        state->canDoubleTap = false;
+        state->lastRelease = 0;
+
+        portUsed[PORT_INDEX(input->port)] = true;
+    }
+
+    /* To determine what other events are available for configuration,
+     * CTRL+click on INT_PORT1. */
+    int port;
+    for (port = 0; port < NUM_INPUT_PORTS; port++)
+    {
+        if (portUsed[port])
+        {
+            GPIO_registerInterrupt(GPIO_PORT_P1 + port, s_portIsrs[port]);
+            Interrupt_enableInterrupt(s_portInterrupts[port]);
+        }
+    }
 }
 
 /**
- * Initializes the Boosterpack JS button with interrupts enabled on a
- * high-to-low transition, or a falling edge.
- *
- * TODO: Add more Boosterpack buttons to this, and tweak or add the ISRs to
- *       generate events upon pressing these other buttons as well.
+ * Starts TIMER_A1 counting continuously on ACLK / 4 for debouncing, gestures
+ * and software timers. Its compare channels stay disabled until a deadline is
+ * armed, so the timer never interrupts while there is nothing to time.
  */
-static void Init_BoosterpackButtons(void)
+static void Init_InputTimer(void)
 {
-    GPIO_setAsInputPin(GPIO_PORT_P4, GPIO_PIN1);
+    Timer_A_ContinuousModeConfig timerConfig =
+    {
+        TIMER_A_CLOCKSOURCE_ACLK,
+        TIMER_A_CLOCKSOURCE_DIVIDER_4,
+        TIMER_A_TAIE_INTERRUPT_DISABLE,
+        TIMER_A_DO_CLEAR
+    };
 
-    GPIO_clearInterruptFlag(GPIO_PORT_P4, GPIO_PIN1);
-    GPIO_enableInterrupt(GPIO_PORT_P4, GPIO_PIN1);
-    GPIO_registerInterrupt(GPIO_PORT_P4, ISR_BoosterpackJS);
-    GPIO_interruptEdgeSelect(
-        GPIO_PORT_P4, GPIO_PIN1, GPIO_HIGH_TO_LOW_TRANSITION);
+    Timer_A_configureContinuousMode(INPUT_TIMER, &timerConfig);
+    Timer_A_disableCaptureCompareInterrupt(INPUT_TIMER, INPUT_TIMER_CHANNEL);
+    Timer_A_clearCaptureCompareInterrupt(INPUT_TIMER, INPUT_TIMER_CHANNEL);
+    Timer_A_disableCaptureCompareInterrupt(INPUT_TIMER, SOFT_TIMER_CHANNEL);
+    Timer_A_clearCaptureCompareInterrupt(INPUT_TIMER, SOFT_TIMER_CHANNEL);
+
+    Timer_A_registerInterrupt(INPUT_TIMER,
+        TIMER_A_CCRX_AND_OVERFLOW_INTERRUPT, ISR_InputTimer);
+    Interrupt_enableInterrupt(INT_TA1_N);
+
+    Timer_A_startCounter(INPUT_TIMER, TIMER_A_CONTINUOUS_MODE);
+}
+
+/**
+ * Registers the RTC's interrupt, which wakes the processor up from LPM3 for
+ * software timers. The RTC itself is already running, since InitSystemTiming()
+ * started it, but its interval interrupt is only enabled while asleep.
+ */
+static void Init_RtcWakeup(void)
+{
+    RTC_C_disableInterrupt(RTC_C_PRESCALE_TIMER1_INTERRUPT);
+    RTC_C_clearInterruptFlag(RTC_C_PRESCALE_TIMER1_INTERRUPT);
 
-    Interrupt_enableInterrupt(INT_PORT4);
+    RTC_C_registerInterrupt(ISR_RtcWakeup);
+    Interrupt_enableInterrupt(INT_RTC_C);
 }
 
 /******************************************************************************/
@@ -281,8 +1216,9 @@ void Init_InterruptHal(void)
     Init_HALVariables();
 
     /* Input peripheral initialization */
-    Init_LaunchpadButtons();
-    Init_BoosterpackButtons();
+    Init_InputTimer();
+    Init_RtcWakeup();
+    Init_InputPins();
 
     /* Output initialization */
     Init_LaunchpadLEDs();
@@ -297,44 +1233,449 @@ void Init_InterruptHal(void)
 }
 
 /**
- * Clears all interrupt event flags, then puts the processor to sleep. Since we
- * expect an ISR to write to one (or more) interrupt event flags, we need to
- * clear them here (reset booleans flags, reset state counters, etc.)
+ * Puts the processor to sleep until at least one event is pending, then
+ * returns. Every event an ISR logs stays in the event queue until the main
+ * application pops it with [InterruptHal_NextEvent()], so there is nothing to
+ * clear here.
+ *
+ * The check for pending events and the sleep itself must be atomic. If an ISR
+ * logged an event after we checked for pending events but before we went to
+ * sleep, we would sleep with work pending until some unrelated interrupt woke
+ * us up. To close that window, we mask interrupts first. WFI still wakes the
+ * processor on a pending interrupt while interrupts are masked - the ISR simply
+ * runs as soon as we unmask them again after waking up.
  */
 void SleepProcessor(void)
 {
-    s_hal.L1Tapped = false;
-    s_hal.JSTapped = false;
+    Interrupt_disableMaster();
+
+    /* An ISR may have fired while the main loop was still dispatching. If so,
+     * there is work to do right now and no reason to sleep at all. */
+    if (s_hal.pendingEvents != 0)
+    {
+        s_hal.sleepStats.skippedSleeps++;
+        s_hal.lastWake = Clock_now();
+        Interrupt_enableMaster();
+        return;
+    }
+
+    while (true)
+    {
+        /* After this line, your MSP432 will sleep until an ISR awakens it. The
+         * governor picks the low-power mode again before every sleep, since
+         * the last ISR may have armed or disarmed a deadline. */
+        s_hal.sleepStats.sleeps++;
+
+        uint64_t asleepSince = Clock_now();
+        uint64_t isrTimeSince = s_hal.isrTime;
+        uint32_t isrExitsSince = s_hal.isrExits;
+
+        /* Deep sleep has to hand timekeeping back to TIMER32_0 after every
+         * wakeup, so only LPM0 may be re-entered straight from an ISR. */
+        SleepMode mode = ChooseSleepMode();
+        bool sleepOnExit = s_hal.sleepOnExit && (mode == SLEEP_MODE_LPM0);
+
+        if (sleepOnExit)
+            Interrupt_enableSleepOnIsrExit();
+
+        mode = EnterSleepMode(mode);
+
+        if (!sleepOnExit)
+        {
+            s_hal.power.asleep[mode] += Clock_now() - asleepSince;
+            s_hal.power.wakeups++;
+        }
+
+        /* Let the pending ISR(s) run, then mask again before looking at the
+         * queue so that the check and the next sleep stay atomic. While
+         * sleeping on exit, we only get past this point once an ISR has
+         * cleared SLEEPONEXIT, and every ISR before it ran from sleep. */
+        Interrupt_enableMaster();
+        Interrupt_disableMaster();
+
+        if (sleepOnExit)
+        {
+            Interrupt_disableSleepOnIsrExit();
+
+            uint32_t wakeups = s_hal.isrExits - isrExitsSince;
+            s_hal.power.asleep[mode] += (Clock_now() - asleepSince)
+                                      - (s_hal.isrTime - isrTimeSince);
+            s_hal.power.wakeups += (wakeups != 0) ? wakeups : 1;
+        }
+
+        if (s_hal.pendingEvents != 0)
+            break;
+
+        /* Something woke us up without logging an event (for example, the
+         * TIMER32_0 rollover ISR in SWTimer.c). Go straight back to sleep
+         * instead of running an empty dispatch pass in main(). */
+        s_hal.sleepStats.emptyWakeups++;
+    }
+
+    /* Interrupts are still masked, so [lastIsrExit] cannot change under us. */
+    s_hal.lastWake = Clock_now();
+    LatencyHistogram_record(&s_hal.latency[LATENCY_ISR_TO_WAKE],
+                            s_hal.lastWake - s_hal.lastIsrExit);
+
+    Interrupt_enableMaster();
+}
+
+/**
+ * Sets the deepest low-power mode [SleepProcessor()] may choose. Defaults to
+ * SLEEP_MODE_LPM3. Allow SLEEP_MODE_LPM4 only if your application does not
+ * mind [Clock_now()] standing still while there is nothing to do, and limit it
+ * to SLEEP_MODE_LPM0 while using a peripheral which needs a fast clock but
+ * does not interrupt (for example, a DMA transfer).
+ *
+ * @param mode:     The deepest low-power mode to allow
+ */
+void InterruptHal_SetDeepestSleep(SleepMode mode)
+{
+    s_hal.deepestSleep = mode;
+}
+
+/**
+ * Hands every future event of one source to [handler] right inside the ISR
+ * which logs it, instead of queueing it for the main application. Passing NULL
+ * queues the source's events again. Records of the source which are already
+ * queued are still handed to the main application.
+ *
+ * @param id:       The event source to handle in the ISR
+ * @param handler:  The function the ISR calls for each occurrence, or NULL
+ */
+void InterruptHal_HandleInIsr(EventId id, IsrEventHandler handler)
+{
+    bool wasDisabled = Interrupt_disableMaster();
+    s_hal.sources[id].isrHandler = handler;
 
-    /* After this line, your MSP432 will sleep until an ISR awakens it. */
-    PCM_gotoLPM0();
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+}
+
+/**
+ * Enables or disables sleep-on-exit mode. Disabled by default. Only worth
+ * enabling if some sources are handled with [InterruptHal_HandleInIsr()] -
+ * otherwise, every ISR which logs an event wakes the main application anyway.
+ *
+ * @param enable:   Whether [SleepProcessor()] should sleep on ISR exit
+ */
+void InterruptHal_SetSleepOnExit(bool enable)
+{
+    s_hal.sleepOnExit = enable;
+}
+
+/**
+ * Returns a copy of the sleep bookkeeping counters. [emptyWakeups] counts the
+ * times the processor woke up without any work to do, and [skippedSleeps]
+ * counts the times [SleepProcessor()] returned immediately because work was
+ * already pending when it was called.
+ */
+SleepStats InterruptHal_SleepStats(void)
+{
+    return s_hal.sleepStats;
+}
+
+/**
+ * Records the time from the last wakeup until now in the
+ * LATENCY_WAKE_TO_HANDLED histogram, and the time the handler took in the
+ * event's power accounting. The event dispatcher calls this after every
+ * handler it runs, so you do not need to call this yourself unless you dispatch
+ * events manually.
+ *
+ * @param id:       The event whose handler just returned
+ * @param start:    When the handler was called, from [Clock_now()]
+ */
+void InterruptHal_LogHandled(EventId id, uint64_t start)
+{
+    uint64_t now = Clock_now();
+
+    LatencyHistogram_record(&s_hal.latency[LATENCY_WAKE_TO_HANDLED],
+                            now - s_hal.lastWake);
+    s_hal.power.handler[id] += now - start;
+}
+
+/**
+ * Returns a copy of one of the latency histograms. Interrupts are masked while
+ * copying, so an ISR cannot record a sample halfway through the copy.
+ *
+ * @param kind:     Which histogram to copy
+ * @return a snapshot of the histogram, in [Clock_now()] ticks
+ */
+LatencyHistogram InterruptHal_Latency(LatencyKind kind)
+{
+    bool wasDisabled = Interrupt_disableMaster();
+    LatencyHistogram histogram = s_hal.latency[kind];
+
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+
+    return histogram;
+}
+
+/** Discards every sample recorded in all of the latency histograms. */
+void InterruptHal_ResetLatency(void)
+{
+    bool wasDisabled = Interrupt_disableMaster();
+
+    int i;
+    for (i = 0; i < NUM_LATENCY_KINDS; i++)
+        LatencyHistogram_reset(&s_hal.latency[i]);
+
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+}
+
+/******************************************************************************/
+/* POWER ACCOUNTING                                                           */
+/******************************************************************************/
+
+/**
+ * Returns the charge drawn over [ticks] at [nanoamps], in nC. Whole seconds and
+ * the remaining ticks are multiplied separately, since ticks times nanoamps
+ * overflows 64 bits after about 100 hours at 48 MHz.
+ */
+static uint64_t ChargeOf(uint64_t ticks, uint32_t nanoamps)
+{
+    uint64_t seconds = ticks / CYCLES_PER_SECOND;
+    uint64_t remainder = ticks % CYCLES_PER_SECOND;
+
+    return seconds * nanoamps + (remainder * nanoamps) / CYCLES_PER_SECOND;
+}
+
+/**
+ * Returns a copy of the power-mode residencies, along with the wakeup rate and
+ * the estimated charge drawn since the last reset. Interrupts are masked while
+ * copying, so an ISR cannot add to a residency halfway through the copy.
+ *
+ * Multiply [charge] by your battery voltage to estimate energy, or divide it by
+ * 3600000 to get it in microamp-hours.
+ */
+PowerStats InterruptHal_PowerStats(void)
+{
+    bool wasDisabled = Interrupt_disableMaster();
+    PowerStats stats = s_hal.power;
+    stats.elapsed = Clock_now() - s_hal.powerSince;
+
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+
+    uint64_t asleep = 0;
+    uint64_t charge = 0;
+
+    int mode;
+    for (mode = 0; mode < NUM_SLEEP_MODES; mode++)
+    {
+        asleep += stats.asleep[mode];
+        charge += ChargeOf(stats.asleep[mode], s_hal.powerModel.asleep[mode]);
+    }
+
+    stats.active = stats.elapsed - asleep;
+    charge += ChargeOf(stats.active, s_hal.powerModel.active);
+
+    stats.charge = charge;
+
+    if (stats.elapsed != 0)
+    {
+        stats.milliWakeupsPerSecond = (uint32_t)
+            ((stats.wakeups * 1000ull * CYCLES_PER_SECOND) / stats.elapsed);
+    }
+
+    return stats;
+}
+
+/** Discards every residency, ISR time and wakeup counted so far. */
+void InterruptHal_ResetPowerStats(void)
+{
+    bool wasDisabled = Interrupt_disableMaster();
+
+    PowerStats empty = { 0 };
+    s_hal.power = empty;
+    s_hal.powerSince = Clock_now();
+
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+}
+
+/**
+ * Sets the supply currents used to estimate the charge drawn. Only affects the
+ * estimate, so this can be called at any time without resetting the stats.
+ *
+ * @param model:    The current drawn in each power mode, in nanoamps
+ */
+void InterruptHal_SetPowerModel(PowerModel model)
+{
+    s_hal.powerModel = model;
+}
+
+/**
+ * Adds the time an ISR took to run to its power accounting, and counts it as a
+ * wakeup if it ran while the processor was sleeping on exit. The ISRs in this
+ * file call this through [LogIsrExit()]. Call it as the very last thing in any
+ * other ISR which can run while the main application sleeps, such as the LCD's,
+ * so that its time is not counted as sleep.
+ *
+ * @param isr:          Which ISR is returning
+ * @param entryTime:    When the ISR was entered, from [Clock_now()]
+ */
+void InterruptHal_LogIsrTime(IsrSource isr, uint64_t entryTime)
+{
+    uint64_t elapsed = Clock_now() - entryTime;
+
+    s_hal.power.isr[isr] += elapsed;
+    s_hal.isrTime += elapsed;
+    s_hal.isrExits++;
+}
+
+/******************************************************************************/
+/* SOFTWARE TIMERS                                                            */
+/******************************************************************************/
+
+/**
+ * Starts (or restarts) a software timer. A one-shot timer expires once,
+ * [delayMs] from now. A periodic timer first expires [delayMs] from now and
+ * then every [periodMs] after that, until it is cancelled. Interrupts are
+ * masked while the heap changes, so this may be called from anywhere.
+ *
+ * @param timer:    The timer to start, which must stay in memory while running
+ * @param delayMs:  How long until the timer first expires, in ms
+ * @param periodMs: The time between expiries in ms, or 0 for a one-shot timer
+ * @return true if the timer was started, false if too many are running
+ */
+bool InterruptHal_StartTimer(SoftTimer* timer, uint32_t delayMs,
+                             uint32_t periodMs)
+{
+    bool wasDisabled = Interrupt_disableMaster();
+
+    if (SoftTimer_isRunning(timer))
+        TimerHeap_remove(&s_hal.softTimers, timer);
+
+    timer->deadline = Clock_now() + MS_TO_CYCLES(delayMs);
+    timer->period = MS_TO_CYCLES(periodMs);
+
+    bool started = TimerHeap_insert(&s_hal.softTimers, timer);
+    SoftTimers_schedule();
+
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+
+    return started;
+}
+
+/**
+ * Stops a software timer, so that it does not expire again until it is started
+ * again. Cancelling a timer which is not running does nothing.
+ *
+ * @param timer:    The timer to stop
+ */
+void InterruptHal_CancelTimer(SoftTimer* timer)
+{
+    bool wasDisabled = Interrupt_disableMaster();
+
+    if (SoftTimer_isRunning(timer))
+    {
+        TimerHeap_remove(&s_hal.softTimers, timer);
+        SoftTimers_schedule();
+    }
+
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+}
+
+/******************************************************************************/
+/* EVENT POLICIES                                                             */
+/******************************************************************************/
+
+/**
+ * Sets how the ISRs log events of one source from now on, and resets that
+ * source's merged and dropped counters. Interrupts are masked while the policy
+ * changes, so an ISR never sees half of the old policy and half of the new.
+ *
+ * @param id:       The event source to configure
+ * @param policy:   The policy to enforce for that source
+ */
+void InterruptHal_SetEventPolicy(EventId id, EventPolicy policy)
+{
+    EventSource* source = &s_hal.sources[id];
+    bool wasDisabled = Interrupt_disableMaster();
+
+    source->policy = policy;
+    source->window = MS_TO_CYCLES(policy.limit);
+    source->stats.merged = 0;
+    source->stats.dropped = 0;
+    source->windowStart = 0;
+    source->windowCount = 0;
+
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+}
+
+/**
+ * Returns a copy of one source's merged and dropped counters. If [dropped]
+ * keeps growing, the source fires faster than its rate limit allows.
+ *
+ * @param id:   The event source to examine
+ * @return the counters since the source's policy was last set
+ */
+EventPolicyStats InterruptHal_EventPolicyStats(EventId id)
+{
+    bool wasDisabled = Interrupt_disableMaster();
+    EventPolicyStats stats = s_hal.sources[id].stats;
+
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+
+    return stats;
 }
 
 /******************************************************************************/
-/* EVENT FLAG GETTERS                                                         */
+/* EVENT QUEUE ACCESS                                                         */
 /* -------------------------------------------------------------------------- */
-/* Basic getters which return a copy of the event flags set by the ISRs. We   */
-/* use these functions in our interrupt dispatcher in the main application to */
-/* determine what interrupts occurred (for example, if any buttons were       */
-/* pressed or if hardware timers have expired). We need these getters so that */
-/* we can at least read the members of s_hal outside of this file (recall     */
-/* that [s_hal] is static and cannot be directly accessed!)                   */
+/* The main application drains the events logged by the ISRs through these    */
+/* functions. We need them so that we can at least read the event queue       */
+/* outside of this file (recall that [s_hal] is static and cannot be directly */
+/* accessed!)                                                                 */
 /******************************************************************************/
 
 /**
- * Returns whether the left launchpad button was tapped from the last time the
- * processor was put to sleep.
+ * Atomically returns the set of events logged since the last call and clears
+ * it, as a bitfield with one bit per event ID (see [EVENT_BIT()]). This is a
+ * single exclusive load/store pair: if an ISR sets a bit between the two, the
+ * store fails and we simply try again, so no event can be set after we read
+ * the word but before we clear it.
+ *
+ * [SleepProcessor()] will not sleep while any bit is set, so the main loop must
+ * take the events on every pass.
+ */
+uint32_t InterruptHal_TakeEvents(void)
+{
+    uint32_t events;
+
+    do
+    {
+        events = __LDREXW(&s_hal.pendingEvents);
+    } while (__STREXW(0, &s_hal.pendingEvents) != 0);
+
+    return events;
+}
+
+/**
+ * Pops the oldest event logged by an ISR. Call this in a loop after waking up
+ * until it returns false, so that every event is handled in a single pass.
+ *
+ * @param event:    Filled in with the oldest pending event, if there is one
+ * @return true if an event was retrieved, false if no events are pending
  */
-bool LaunchpadS1_Tapped(void)
+bool InterruptHal_NextEvent(Event* event)
 {
-    return s_hal.L1Tapped;
+    return EventQueue_pop(&s_hal.events, event);
 }
 
 /**
- * Returns whether the joystick button was tapped from the last time the
- * processor was put to sleep.
+ * Returns the number of events which were dropped because the event queue was
+ * full. If this is ever non-zero, either the main loop is taking too long to
+ * dispatch events or EVENT_QUEUE_CAPACITY is too small.
  */
-bool BoosterpackJS_Tapped(void)
+uint32_t InterruptHal_DroppedEvents(void)
 {
-    return s_hal.JSTapped;
+    return EventQueue_overflows(&s_hal.events);
 }
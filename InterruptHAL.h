@@ -10,6 +10,9 @@
 #define INTERRUPTHAL_H_
 
 #include <stdbool.h>
+#include <EventQueue.h>
+#include <LatencyHistogram.h>
+#include <TimerHeap.h>
 
 /** The master initialization function. Call this in your main. */
 void Init_InterruptHal(void);
@@ -32,11 +35,202 @@ void LaunchpadLED2_TurnOff(void);
 void LaunchpadLED1_Toggle(void);
 void LaunchpadLED2_Toggle(void);
 
-/** Retrieves the most recent event(s) generated by a relevant ISR. */
-bool LaunchpadS1_Tapped(void);
-bool BoosterpackJS_Tapped(void);
+/** Snapshots and clears the set of events generated since the last call. */
+uint32_t InterruptHal_TakeEvents(void);
 
-/** Resets all interrupt event flags, then puts the microcontroller to sleep. */
+/** Retrieves the events generated by the ISRs, oldest first. */
+bool InterruptHal_NextEvent(Event* event);
+uint32_t InterruptHal_DroppedEvents(void);
+
+/**
+ * Per-source event policies, enforced by the ISRs as they log events. Every
+ * source starts out with EVENT_POLICY_KEEP_ALL.
+ * - EVENT_POLICY_KEEP_ALL:     Queue every occurrence as its own record
+ * - EVENT_POLICY_COALESCE:     Merge repeats into a queued record of the same
+ *                              event which is at most [limit] ms old, counting
+ *                              them in the record's [count]
+ * - EVENT_POLICY_RATE_LIMIT:   Queue at most [limit] records per second, and
+ *                              drop the rest
+ * - EVENT_POLICY_KEEP_LATEST:  Replace a queued record of the same event with
+ *                              each newer occurrence, counting them in [count]
+ *
+ * Merged and dropped occurrences do not wake the main application.
+ */
+enum _EventPolicyKind
+{
+    EVENT_POLICY_KEEP_ALL,
+    EVENT_POLICY_COALESCE,
+    EVENT_POLICY_RATE_LIMIT,
+    EVENT_POLICY_KEEP_LATEST
+};
+typedef enum _EventPolicyKind EventPolicyKind;
+
+struct _EventPolicy
+{
+    EventPolicyKind kind;
+    uint32_t limit;     // Window in ms, or records per second, as above
+};
+typedef struct _EventPolicy EventPolicy;
+
+/** How many occurrences of one source its policy has merged and dropped. */
+struct _EventPolicyStats
+{
+    uint32_t merged;    // Occurrences merged into (or replacing) a record
+    uint32_t dropped;   // Occurrences dropped by EVENT_POLICY_RATE_LIMIT
+};
+typedef struct _EventPolicyStats EventPolicyStats;
+
+void InterruptHal_SetEventPolicy(EventId id, EventPolicy policy);
+EventPolicyStats InterruptHal_EventPolicyStats(EventId id);
+
+/**
+ * Software timers, serviced from a single compare channel of TIMER_A1 which is
+ * always programmed for the earliest deadline, so the processor only wakes up
+ * when a timer is actually due. Deadlines are kept in [Clock_now()] ticks and
+ * periodic timers are rescheduled from their previous deadline rather than from
+ * when they were serviced, so they never drift. If a periodic timer falls more
+ * than a whole period behind, the missed expiries are skipped, not bunched up.
+ *
+ * While a timer is running, the idle governor still lets the processor sleep
+ * in LPM3 (but not LPM4), and has the RTC wake it up in time for the earliest
+ * deadline, at least every two seconds. Only the last 1/64 s or so is spent in
+ * LPM0, where TIMER_A1 keeps counting.
+ *
+ * Start returns false if TIMER_HEAP_CAPACITY timers are already running.
+ * Starting a running timer restarts it. Both may be called from callbacks.
+ */
+bool InterruptHal_StartTimer(SoftTimer* timer, uint32_t delayMs,
+                             uint32_t periodMs);
+void InterruptHal_CancelTimer(SoftTimer* timer);
+
+/**
+ * Sleep bookkeeping counters, used to measure how often the processor wakes up
+ * for nothing and how often events arrive while the main loop is still busy.
+ */
+struct _SleepStats
+{
+    uint32_t sleeps;        // Number of times the processor went to sleep
+    uint32_t deepSleeps;    // How many of those were in LPM3 or LPM4
+    uint32_t emptyWakeups;  // Wakeups which found no pending events
+    uint32_t skippedSleeps; // Sleeps skipped because events were pending
+};
+typedef struct _SleepStats SleepStats;
+
+/**
+ * The low-power modes [SleepProcessor()] chooses from, lightest first.
+ * - SLEEP_MODE_LPM0:   The CPU stops, every clock and peripheral keeps running
+ * - SLEEP_MODE_LPM3:   Only the RTC and the watchdog keep running, but
+ *                      [Clock_now()] and SWTimers still count the time slept
+ * - SLEEP_MODE_LPM4:   Every clock stops, only GPIO interrupts can wake the
+ *                      processor, and [Clock_now()] stands still while asleep
+ */
+enum _SleepMode
+{
+    SLEEP_MODE_LPM0,
+    SLEEP_MODE_LPM3,
+    SLEEP_MODE_LPM4,
+
+    NUM_SLEEP_MODES
+};
+typedef enum _SleepMode SleepMode;
+
+/** Puts the microcontroller to sleep until an ISR logs an event. */
 void SleepProcessor(void);
+SleepStats InterruptHal_SleepStats(void);
+void InterruptHal_SetDeepestSleep(SleepMode mode);
+
+/**
+ * Sleep-on-exit mode, for events which need so little work that waking up the
+ * main application for them costs more than the work itself.
+ *
+ * An event with an ISR handler is handed to that handler by the ISR which logs
+ * it, instead of being queued. Event policies do not apply, and the main
+ * application is not woken up for it. ISR handlers run with interrupts of equal
+ * or lower priority blocked, so keep them short and never block in them.
+ *
+ * With sleep-on-exit enabled, [SleepProcessor()] sets SLEEPONEXIT while in
+ * LPM0, so that the processor goes straight back to sleep from the tail of
+ * every ISR. It only returns to the main application once an ISR queues an
+ * event which needs it, or the idle governor may now pick a deeper sleep.
+ */
+typedef void (*IsrEventHandler)(const Event* event);
+
+void InterruptHal_HandleInIsr(EventId id, IsrEventHandler handler);
+void InterruptHal_SetSleepOnExit(bool enable);
+
+/**
+ * Latency histograms, recorded at all times in [Clock_now()] ticks.
+ * - LATENCY_ISR:               Time spent inside each ISR which logs events
+ * - LATENCY_ISR_TO_WAKE:       Time from the last ISR returning until the main
+ *                              application resumes after [SleepProcessor()]
+ * - LATENCY_WAKE_TO_HANDLED:   Time from the main application resuming until
+ *                              each event handler completes
+ */
+enum _LatencyKind
+{
+    LATENCY_ISR,
+    LATENCY_ISR_TO_WAKE,
+    LATENCY_WAKE_TO_HANDLED,
+
+    NUM_LATENCY_KINDS
+};
+typedef enum _LatencyKind LatencyKind;
+
+LatencyHistogram InterruptHal_Latency(LatencyKind kind);
+void InterruptHal_ResetLatency(void);
+void InterruptHal_LogHandled(EventId id, uint64_t start);
+
+/** The ISRs whose run time is accounted for in [PowerStats]. */
+enum _IsrSource
+{
+    ISR_SOURCE_PORT1,
+    ISR_SOURCE_PORT2,
+    ISR_SOURCE_PORT3,
+    ISR_SOURCE_PORT4,
+    ISR_SOURCE_PORT5,
+    ISR_SOURCE_PORT6,
+    ISR_SOURCE_INPUT_TIMER,
+    ISR_SOURCE_LCD_SPI,
+    ISR_SOURCE_LCD_DMA,
+
+    NUM_ISR_SOURCES
+};
+typedef enum _IsrSource IsrSource;
+
+/**
+ * The supply current drawn in each power mode, in nanoamps, used to turn
+ * residencies into an estimated charge. The defaults are rough datasheet
+ * figures - measure your own board for better estimates.
+ */
+struct _PowerModel
+{
+    uint32_t active;                    // CPU running (including ISRs)
+    uint32_t asleep[NUM_SLEEP_MODES];   // Sleeping in each low-power mode
+};
+typedef struct _PowerModel PowerModel;
+
+/**
+ * Power-mode residencies since the last [InterruptHal_ResetPowerStats()], all
+ * in [Clock_now()] ticks. Time spent in LPM4 cannot be measured, since every
+ * clock stops, so it never shows up in [elapsed] or [asleep].
+ */
+struct _PowerStats
+{
+    uint64_t elapsed;                   // Total time measured
+    uint64_t active;                    // Time awake, including ISRs
+    uint64_t asleep[NUM_SLEEP_MODES];   // Time asleep in each low-power mode
+    uint64_t isr[NUM_ISR_SOURCES];      // Time spent inside each ISR
+    uint64_t handler[NUM_EVENT_IDS];    // Time spent in each event's handler
+
+    uint32_t wakeups;                   // Number of times the processor woke up
+    uint32_t milliWakeupsPerSecond;     // Wakeups per 1000 seconds
+    uint64_t charge;                    // Estimated charge drawn, in nC
+};
+typedef struct _PowerStats PowerStats;
+
+PowerStats InterruptHal_PowerStats(void);
+void InterruptHal_ResetPowerStats(void);
+void InterruptHal_SetPowerModel(PowerModel model);
+void InterruptHal_LogIsrTime(IsrSource isr, uint64_t entryTime);
 
 #endif /* INTERRUPTHAL_H_ */
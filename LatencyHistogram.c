@@ -0,0 +1,99 @@
+/*
+ * LatencyHistogram.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ */
+
+#include <LatencyHistogram.h>
+
+/**
+ * Returns the bucket a sample belongs to, i.e. the number of significant bits
+ * in the sample. A binary search over the bit position keeps this at five
+ * steps regardless of the sample, without relying on a compiler intrinsic.
+ */
+static uint32_t BucketOf(uint32_t cycles)
+{
+    uint32_t bucket = 0;
+
+    if (cycles >= (1u << 16)) { bucket += 16; cycles >>= 16; }
+    if (cycles >= (1u << 8))  { bucket += 8;  cycles >>= 8;  }
+    if (cycles >= (1u << 4))  { bucket += 4;  cycles >>= 4;  }
+    if (cycles >= (1u << 2))  { bucket += 2;  cycles >>= 2;  }
+    if (cycles >= (1u << 1))  { bucket += 1;  cycles >>= 1;  }
+
+    return bucket + cycles;
+}
+
+/** Discards every sample recorded in the histogram. */
+void LatencyHistogram_reset(LatencyHistogram* histogram)
+{
+    int i;
+    for (i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++)
+        histogram->buckets[i] = 0;
+
+    histogram->count = 0;
+    histogram->min = UINT32_MAX;
+    histogram->max = 0;
+    histogram->total = 0;
+}
+
+/**
+ * Records a single latency sample. Samples which do not fit in 32 bits are
+ * clamped into the last bucket.
+ *
+ * @param histogram:    The histogram to record into
+ * @param cycles:       The latency to record, in clock cycles
+ */
+void LatencyHistogram_record(LatencyHistogram* histogram, uint64_t cycles)
+{
+    uint32_t sample = (cycles > UINT32_MAX) ? UINT32_MAX : (uint32_t) cycles;
+
+    histogram->buckets[BucketOf(sample)]++;
+    histogram->count++;
+    histogram->total += sample;
+
+    if (sample < histogram->min)
+        histogram->min = sample;
+
+    if (sample > histogram->max)
+        histogram->max = sample;
+}
+
+/**
+ * Finds the bucket which contains the given percentile of all samples and
+ * returns the largest latency that bucket can hold. The true percentile is
+ * therefore at most this value and at least half of it. The result is also
+ * clamped to the largest sample actually recorded.
+ *
+ * @param histogram:    The histogram to examine
+ * @param percent:      The percentile to find, from 0 to 100
+ * @return an upper bound on the percentile in cycles, or 0 if there are no
+ *         samples
+ */
+uint32_t LatencyHistogram_percentile(
+    const LatencyHistogram* histogram, uint32_t percent)
+{
+    if (histogram->count == 0)
+        return 0;
+
+    /* The rank of the sample we are looking for, rounded up and at least 1. */
+    uint64_t rank = ((uint64_t) histogram->count * percent + 99) / 100;
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    int i;
+    for (i = 0; i < LATENCY_HISTOGRAM_BUCKETS - 1; i++)
+    {
+        seen += histogram->buckets[i];
+
+        if (seen >= rank)
+        {
+            uint32_t upperBound = (i == 0) ? 0 : (uint32_t) ((1ull << i) - 1);
+            return (upperBound < histogram->max) ? upperBound : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
@@ -0,0 +1,41 @@
+/*
+ * LatencyHistogram.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  A fixed-size histogram of latencies with power-of-two buckets. Recording a
+ *  sample is a handful of instructions and never allocates, so histograms can
+ *  stay enabled in ISRs at all times. This module only deals with numbers of
+ *  cycles - it never reads a clock itself and has no hardware dependencies, so
+ *  it can be compiled and exercised on a host machine with a stubbed clock.
+ */
+
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+#include <stdint.h>
+
+/* Bucket 0 holds samples of 0 cycles, and bucket i (for i > 0) holds samples
+ * in the range [2^(i-1), 2^i - 1]. 33 buckets cover every 32-bit sample. */
+#define LATENCY_HISTOGRAM_BUCKETS   (33)
+
+struct _LatencyHistogram
+{
+    uint32_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+
+    uint32_t count;     // Number of samples recorded
+    uint32_t min;       // Smallest sample recorded, in cycles
+    uint32_t max;       // Largest sample recorded, in cycles
+    uint64_t total;     // Sum of all samples, in cycles
+};
+typedef struct _LatencyHistogram LatencyHistogram;
+
+void LatencyHistogram_reset(LatencyHistogram* histogram);
+void LatencyHistogram_record(LatencyHistogram* histogram, uint64_t cycles);
+
+// Returns an upper bound on the given percentile (0-100) of the samples, in cycles.
+uint32_t LatencyHistogram_percentile(
+    const LatencyHistogram* histogram, uint32_t percent);
+
+#endif /* LATENCYHISTOGRAM_H_ */
@@ -0,0 +1,148 @@
+/*
+ * LatencyHistogram_test.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  Host-side checks for LatencyHistogram. The module never reads a clock
+ *  itself, so the samples here come from a stubbed cycle counter which the
+ *  test advances by hand. This file has its own main() and is excluded from
+ *  the CCS build; build and run it on the host with:
+ *
+ *      gcc -std=c99 -Wall -I. LatencyHistogram_test.c -o latency_test
+ *      ./latency_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Included rather than linked, to reach the static BucketOf()
+#include "LatencyHistogram.c"
+
+/* The stubbed clock, in cycles. */
+static uint64_t s_stubCycles = 0;
+
+static uint64_t StubClock_now(void)
+{
+    return s_stubCycles;
+}
+
+static void StubClock_advance(uint64_t cycles)
+{
+    s_stubCycles += cycles;
+}
+
+static int s_failures = 0;
+
+static void Check(const char* what, uint64_t actual, uint64_t expected)
+{
+    if (actual != expected)
+    {
+        printf("FAIL %s: got %llu, expected %llu\n", what,
+               (unsigned long long) actual, (unsigned long long) expected);
+        s_failures++;
+    }
+}
+
+/** Records one sample, timed as [cycles] on the stubbed clock. */
+static void RecordLatency(LatencyHistogram* histogram, uint64_t cycles)
+{
+    uint64_t start = StubClock_now();
+    StubClock_advance(cycles);
+    LatencyHistogram_record(histogram, StubClock_now() - start);
+}
+
+/** Bucket 0 is zero alone, and each power of two starts a new bucket. */
+static void TestBucketEdges(void)
+{
+    char what[32];
+    uint32_t i;
+
+    Check("BucketOf(0)", BucketOf(0), 0);
+    Check("BucketOf(1)", BucketOf(1), 1);
+    Check("BucketOf(UINT32_MAX)", BucketOf(UINT32_MAX), 32);
+
+    for (i = 1; i < 32; i++)
+    {
+        sprintf(what, "BucketOf(2^%u)", (unsigned) i);
+        Check(what, BucketOf(1u << i), i + 1);
+
+        sprintf(what, "BucketOf(2^%u - 1)", (unsigned) i);
+        Check(what, BucketOf((1u << i) - 1), i);
+    }
+
+    Check("BucketOf(2^31 + 1)", BucketOf((1u << 31) + 1), 32);
+}
+
+/** Samples of 1 to 100 cycles, which fill buckets 1 to 7. */
+static void TestPercentiles(void)
+{
+    LatencyHistogram histogram;
+    uint32_t i;
+
+    LatencyHistogram_reset(&histogram);
+    Check("empty p50", LatencyHistogram_percentile(&histogram, 50), 0);
+
+    for (i = 1; i <= 100; i++)
+        RecordLatency(&histogram, i);
+
+    Check("count", histogram.count, 100);
+    Check("min", histogram.min, 1);
+    Check("max", histogram.max, 100);
+    Check("total", histogram.total, 5050);
+
+    // Cumulative counts by bucket: 1, 3, 7, 15, 31, 63, 100
+    Check("p0", LatencyHistogram_percentile(&histogram, 0), 1);
+    Check("p1", LatencyHistogram_percentile(&histogram, 1), 1);
+    Check("p3", LatencyHistogram_percentile(&histogram, 3), 3);
+    Check("p31", LatencyHistogram_percentile(&histogram, 31), 31);
+    Check("p32", LatencyHistogram_percentile(&histogram, 32), 63);
+    Check("p50", LatencyHistogram_percentile(&histogram, 50), 63);
+    Check("p63", LatencyHistogram_percentile(&histogram, 63), 63);
+
+    // The last bucket reaches 127, but no sample was above 100
+    Check("p64", LatencyHistogram_percentile(&histogram, 64), 100);
+    Check("p100", LatencyHistogram_percentile(&histogram, 100), 100);
+}
+
+/** Zero-cycle samples, and samples too large for 32 bits. */
+static void TestExtremes(void)
+{
+    LatencyHistogram histogram;
+
+    LatencyHistogram_reset(&histogram);
+    RecordLatency(&histogram, 0);
+    RecordLatency(&histogram, 0);
+
+    Check("zero bucket", histogram.buckets[0], 2);
+    Check("zero p100", LatencyHistogram_percentile(&histogram, 100), 0);
+
+    RecordLatency(&histogram, 1ull << 40);
+
+    Check("clamped bucket", histogram.buckets[32], 1);
+    Check("clamped max", histogram.max, UINT32_MAX);
+    Check("clamped total", histogram.total, UINT32_MAX);
+    Check("clamped p50", LatencyHistogram_percentile(&histogram, 50), 0);
+    Check("clamped p100", LatencyHistogram_percentile(&histogram, 100),
+          UINT32_MAX);
+
+    LatencyHistogram_reset(&histogram);
+    Check("reset count", histogram.count, 0);
+    Check("reset p100", LatencyHistogram_percentile(&histogram, 100), 0);
+}
+
+int main(void)
+{
+    TestBucketEdges();
+    TestPercentiles();
+    TestExtremes();
+
+    if (s_failures)
+    {
+        printf("%d check(s) failed\n", s_failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All LatencyHistogram checks passed\n");
+    return EXIT_SUCCESS;
+}
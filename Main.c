@@ -16,11 +16,60 @@
 #include "PollingHAL/Graphics.h"
 #include "PollingHAL/SWTimer.h"
 #include "InterruptHAL.h"
+#include "EventLoop.h"
+#include "Profiler.h"
 
 /* Standard Includes */
 #include <stdint.h>
 #include <stdbool.h>
 
+/* Define SLEEP_ON_EXIT_EXAMPLE (add it to the predefined symbols of the build,
+ * or uncomment the line below) to handle Launchpad S1 inside its ISR and let
+ * the processor sleep on exit from ISRs. Without it, S1 is dispatched from the
+ * main loop like every other event. */
+// #define SLEEP_ON_EXIT_EXAMPLE
+
+/**
+ * Event handlers. Each one is registered with [EventLoop_on()] in [main()] and
+ * is called once for every time its event is logged. In this example, we
+ * simply toggle some LEDs, but feel free to replace these with larger functions
+ * similar to [Application_loop()].
+ *
+ * Toggling an LED is so little work that, with SLEEP_ON_EXIT_EXAMPLE defined,
+ * Launchpad S1's handler is registered with [InterruptHal_HandleInIsr()]
+ * instead, and runs inside the port ISR without ever waking up the main loop.
+ */
+static void HandleLaunchpadS1(const Event* event)
+{
+    LaunchpadLED2_Toggle();
+}
+
+/**
+ * Launchpad S2 logs every gesture (see its row in InputPins.h), so its handler
+ * is called for presses, releases, long presses, repeats and double taps alike.
+ * In this example, only a long press does anything: it turns both LEDs off.
+ */
+static void HandleLaunchpadS2(const Event* event)
+{
+    if (event->gesture == GESTURE_LONG_PRESS)
+    {
+        LaunchpadLED1_TurnOff();
+        LaunchpadLED2_TurnOff();
+    }
+}
+
+/**
+ * DO NOT REMOVE THIS HANDLER.
+ * -----------------------------------------------------------------------------
+ * The non-blocking check in your code. We use this to verify that the event
+ * dispatching logic itself is non-blocking - i.e. that anything after the
+ * [SleepProcessor()] is non-blocking.
+ */
+static void HandleBoosterpackJS(const Event* event)
+{
+    LaunchpadLED1_Toggle();
+}
+
 /**
  * The main entry point of your project. In this project, you will design an
  * interrupt-driven program which keeps the microcontroller asleep until
@@ -32,6 +81,10 @@ int main(void)
     /* Initialize the old system timing module for SWTimers. */
     InitSystemTiming();
 
+    /* Start the region profiler. This does nothing unless PROFILING is
+     * defined, in which case [Profiler_stats()] shows where the time goes. */
+    PROFILE_INIT();
+
     /* GFX struct. Works in the same as it did in the previous projects. */
     GFX gfx = GFX_construct(GRAPHICS_COLOR_BLACK, GRAPHICS_COLOR_WHITE);
 
@@ -45,31 +98,37 @@ int main(void)
     LaunchpadLED1_TurnOn();
     LaunchpadLED2_TurnOn();
 
+    /* Register a handler for every event we care about. Events without a
+     * handler are silently discarded during dispatch. */
+    EventLoop_on(EVENT_LAUNCHPAD_S2, HandleLaunchpadS2);
+    EventLoop_on(EVENT_BOOSTERPACK_JS, HandleBoosterpackJS);
+
+#ifdef SLEEP_ON_EXIT_EXAMPLE
+    /* Handle Launchpad S1 in its ISR, and let the processor go straight back
+     * to sleep afterwards instead of returning here for nothing. */
+    InterruptHal_HandleInIsr(EVENT_LAUNCHPAD_S1, HandleLaunchpadS1);
+    InterruptHal_SetSleepOnExit(true);
+#else
+    EventLoop_on(EVENT_LAUNCHPAD_S1, HandleLaunchpadS1);
+#endif
+
     /* Event handler loop. Unlike the previous two projects, in this project,
      * your microcontroller will sleep until events occur, then perform the
-     * proper action by reading a bitfield which tells you what events have
-     * occurred since the last time the processor went to sleep. */
+     * proper action by dispatching the events which have occurred since the
+     * last time the processor went to sleep. */
     while (true)
     {
         /* DO NOT REMOVE THIS LINE. This puts your microcontroller to sleep
-         * until an interrupt occurs. Polling based design approaches will no
+         * until an ISR logs an event. Polling based design approaches will no
          * longer work - this function prevents your processor from polling. */
         SleepProcessor();
 
-        /* Event dispatching logic. Once the processor has awoken, we should
-         * check the status of ALL relevant interrupts and perform appropriate
-         * logic. In this example, we simply toggle some LEDs, but feel free to
-         * replace this with a larger function similar to [Application_loop()]
-         * which dispatches multiple events at once. */
-        if (LaunchpadS1_Tapped())
-            LaunchpadLED2_Toggle();
-
-        /* DO NOT REMOVE THIS IF-STATEMENT.
-         * ---------------------------------------------------------------------
-         * The non-blocking check in your code. We use this to verify that the
-         * event dispatching logic itself is non-blocking - i.e. that anything
-         * after the [SleepProcessor()] is non-blocking. */
-        if (BoosterpackJS_Tapped())
-            LaunchpadLED1_Toggle();
+        /* Event dispatching logic. Once the processor has awoken, we hand
+         * ALL events the ISRs have logged to the handlers registered above.
+         * Events of the same source are handled in the order they occurred,
+         * and a button tapped twice calls its handler twice. */
+        PROFILE_BEGIN(PROFILE_DISPATCH);
+        EventLoop_dispatch();
+        PROFILE_END(PROFILE_DISPATCH);
     }
 }
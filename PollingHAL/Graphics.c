@@ -40,6 +40,7 @@ void GFX_resetColors(GFX *gfx_p)
 void GFX_clear(GFX* gfx_p)
 {
     Graphics_clearDisplay(&gfx_p->context);
+    Graphics_flushBuffer(&gfx_p->context);
 }
 
 void GFX_setForeground(GFX* gfx_p, uint32_t foreground)
@@ -59,4 +60,5 @@ void GFX_drawTitle(GFX *gfx_p, char *title)
     Graphics_setFont(&gfx_p->context, &g_sFontCm16b);
     Graphics_drawStringCentered(
         &gfx_p->context, (int8_t *)title, -1, 64, 10, true);
+    Graphics_flushBuffer(&gfx_p->context);
 }
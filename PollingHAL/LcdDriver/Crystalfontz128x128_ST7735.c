@@ -38,15 +38,116 @@
 
 #include <PollingHAL/LcdDriver/Crystalfontz128x128_ST7735.h>
 #include <PollingHAL/LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h>
+#include <PollingHAL/LcdDriver/LcdShadowBuffer.h>
 #include <ti/grlib/grlib.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <Profiler.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+#ifdef LCD_BENCHMARK
+#include <PollingHAL/SWTimer.h>
+#endif
+
 uint8_t Lcd_Orientation;
 uint16_t Lcd_ScreenWidth, Lcd_ScreenHeigth;
 uint8_t Lcd_PenSolid, Lcd_FontSolid, Lcd_FlagRead;
 uint16_t Lcd_TouchTrim;
 
+//*****************************************************************************
+//
+// The draw window last programmed into the controller, so that CASET and RASET
+// are only sent when they actually change. The window is kept as it was sent,
+// after the orientation's offsets, which keeps it valid across orientation
+// changes.
+//
+// Runs of pixels along one row are written with the window opened up to the
+// right edge of the screen, and the controller's cursor moves on by one pixel
+// with every pixel written. If the next run starts right where the last one
+// ended, it is simply written on the end of the same RAMWR, without sending a
+// single command. This only holds as long as no command has been written since
+// the RAMWR was opened, which HAL_LCD_commandCount() tells.
+//
+//*****************************************************************************
+struct _LcdWindow
+{
+    bool valid;                 // Whether the window below has been sent
+    uint16_t x0, y0, x1, y1;
+
+    bool streaming;             // Whether a RAMWR along one row is open
+    uint16_t x, y;              // Where the next pixel of that RAMWR lands
+    uint32_t commands;          // HAL_LCD_commandCount() right after it opened
+};
+typedef struct _LcdWindow LcdWindow;
+
+static LcdWindow s_lcdWindow;
+
+#ifdef LCD_PIXEL_RUNS
+//*****************************************************************************
+//
+// Pixels drawn one at a time by PixelDraw are not sent right away, but added
+// to a run of pixels along a row or down a column for as long as each one is
+// next to the last. The run is sent as one RAMWR burst when a pixel breaks it,
+// when anything else is drawn, or on Flush, so drawing a line of n pixels
+// costs one window setup per run rather than one per pixel. Which way the run
+// goes is only known once it has a second pixel.
+//
+//*****************************************************************************
+#define LCD_RUN_PIXELS    LCD_HORIZONTAL_MAX
+
+struct _LcdPixelRun
+{
+    uint16_t pixels[LCD_RUN_PIXELS];
+    uint16_t count;
+    int16_t x, y;               // The first pixel of the run
+    bool vertical;              // Whether the run goes down a column
+};
+typedef struct _LcdPixelRun LcdPixelRun;
+
+static LcdPixelRun s_lcdRun;
+
+static void Crystalfontz128x128_FlushRun(void);
+#define LCD_FLUSH_RUN()     Crystalfontz128x128_FlushRun()
+#else
+#define LCD_FLUSH_RUN()     ((void) 0)
+#endif
+
+//*****************************************************************************
+//
+// Pixels translated through a palette are collected in a line buffer and sent
+// with HAL_LCD_writeBuffer16(), rather than queued a byte at a time. The buffer
+// holds a full line, and is sent early if a longer run ever comes along. With
+// LCD_SHADOW_BUFFER defined, the line is drawn into the shadow buffer instead,
+// which only reaches the LCD when it is flushed. At 256 bytes, the buffer is
+// kept out of the 512-byte stack.
+//
+//*****************************************************************************
+#define LCD_LINE_PIXELS    LCD_HORIZONTAL_MAX
+
+static uint16_t s_lcdLine[LCD_LINE_PIXELS];
+
+#ifdef LCD_SHADOW_BUFFER
+#define LCD_LINE_SEND(pixels, count)                                          \
+    do                                                                        \
+    {                                                                         \
+        LcdShadow_writeLine(lX, lY, (pixels), (count));                       \
+        lX += (count);                                                        \
+    } while (0)
+#else
+#define LCD_LINE_SEND(pixels, count)  HAL_LCD_writeBuffer16((pixels), (count))
+#endif
+
+#define LCD_LINE_PUT(pixel)                                                   \
+    do                                                                        \
+    {                                                                         \
+        s_lcdLine[ulLinePixels++] = (pixel);                                  \
+        if (ulLinePixels == LCD_LINE_PIXELS)                                  \
+        {                                                                     \
+            LCD_LINE_SEND(s_lcdLine, ulLinePixels);                           \
+            ulLinePixels = 0;                                                 \
+        }                                                                     \
+    } while (0)
+
 //*****************************************************************************
 //
 //! Initializes the display driver.
@@ -97,21 +198,33 @@ void Crystalfontz128x128_Init(void)
     Lcd_FlagRead  = 0;
     Lcd_TouchTrim = 0;
 
+    // The controller has just been reset, so it holds no window yet
+    s_lcdWindow.valid = false;
+    s_lcdWindow.streaming = false;
+#ifdef LCD_PIXEL_RUNS
+    s_lcdRun.count = 0;
+#endif
+
     Crystalfontz128x128_SetDrawFrame(0, 0, 127, 127);
     HAL_LCD_writeCommand(CM_RAMWR);
-    int i;
-    for (i = 0; i < 16384; i++)
-    {
-        HAL_LCD_writeData(0xFF);
-        HAL_LCD_writeData(0xFF);
-    }
+    HAL_LCD_writeRepeat16(0xFFFF, 16384);
+
+#ifdef LCD_SHADOW_BUFFER
+    LcdShadow_init(0xFFFF);
+#endif
 
     HAL_LCD_delay(10);
     HAL_LCD_writeCommand(CM_DISPON);
 }
 
 
-void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+//*****************************************************************************
+//
+// Programs the draw window, sending CASET and RASET only where the window has
+// changed since it was last programmed.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_SetWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
 {
     switch (Lcd_Orientation) {
         case 0:
@@ -142,18 +255,143 @@ void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1, uin
             break;
     }
 
-    HAL_LCD_writeCommand(CM_CASET);
-    HAL_LCD_writeData((uint8_t)(x0 >> 8));
-    HAL_LCD_writeData((uint8_t)(x0));
-    HAL_LCD_writeData((uint8_t)(x1 >> 8));
-    HAL_LCD_writeData((uint8_t)(x1));
-
-    HAL_LCD_writeCommand(CM_RASET);
-    HAL_LCD_writeData((uint8_t)(y0 >> 8));
-    HAL_LCD_writeData((uint8_t)(y0));
-    HAL_LCD_writeData((uint8_t)(y1 >> 8));
-    HAL_LCD_writeData((uint8_t)(y1));
+    //
+    // Only send the columns and rows which have changed.
+    //
+    if (!s_lcdWindow.valid || x0 != s_lcdWindow.x0 || x1 != s_lcdWindow.x1)
+    {
+        HAL_LCD_writeCommand(CM_CASET);
+        HAL_LCD_writeData((uint8_t)(x0 >> 8));
+        HAL_LCD_writeData((uint8_t)(x0));
+        HAL_LCD_writeData((uint8_t)(x1 >> 8));
+        HAL_LCD_writeData((uint8_t)(x1));
+    }
+
+    if (!s_lcdWindow.valid || y0 != s_lcdWindow.y0 || y1 != s_lcdWindow.y1)
+    {
+        HAL_LCD_writeCommand(CM_RASET);
+        HAL_LCD_writeData((uint8_t)(y0 >> 8));
+        HAL_LCD_writeData((uint8_t)(y0));
+        HAL_LCD_writeData((uint8_t)(y1 >> 8));
+        HAL_LCD_writeData((uint8_t)(y1));
+    }
+
+    s_lcdWindow.valid = true;
+    s_lcdWindow.x0 = x0;
+    s_lcdWindow.y0 = y0;
+    s_lcdWindow.x1 = x1;
+    s_lcdWindow.y1 = y1;
+}
+
+
+void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    // Pixels drawn before must reach the LCD before anything the caller writes
+    LCD_FLUSH_RUN();
+
+    Crystalfontz128x128_SetWindow(x0, y0, x1, y1);
+}
+
+
+//*****************************************************************************
+//
+// Gets the controller ready for the pixels of a rectangle, which the caller
+// then writes in order, left to right and top to bottom. A run along a single
+// row carries on the last RAMWR if the cursor is already where it starts, and
+// otherwise opens a new one whose window reaches the right edge of the screen,
+// so that the next run may carry on from it in turn.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_BeginWrite(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+    if (y0 != y1)
+    {
+        Crystalfontz128x128_SetWindow(x0, y0, x1, y1);
+        HAL_LCD_writeCommand(CM_RAMWR);
+
+        s_lcdWindow.streaming = false;
+        return;
+    }
+
+    bool carriesOn = s_lcdWindow.streaming
+                  && s_lcdWindow.commands == HAL_LCD_commandCount()
+                  && s_lcdWindow.x == x0 && s_lcdWindow.y == y0;
+
+    if (!carriesOn)
+    {
+        Crystalfontz128x128_SetWindow(x0, y0, LCD_HORIZONTAL_MAX - 1, y0);
+        HAL_LCD_writeCommand(CM_RAMWR);
+
+        s_lcdWindow.streaming = true;
+        s_lcdWindow.y = y0;
+        s_lcdWindow.commands = HAL_LCD_commandCount();
+    }
+
+    // Past the right edge, the cursor wraps around, and no run can carry on
+    s_lcdWindow.x = x1 + 1;
+}
+
+
+#ifdef LCD_PIXEL_RUNS
+//*****************************************************************************
+//
+// Sends the pending run of pixels, if there is one.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_FlushRun(void)
+{
+    uint16_t count = s_lcdRun.count;
+    if (count == 0)
+        return;
+
+    s_lcdRun.count = 0;
+
+    if (s_lcdRun.vertical)
+        Crystalfontz128x128_BeginWrite(s_lcdRun.x, s_lcdRun.y, s_lcdRun.x, s_lcdRun.y + count - 1);
+    else
+        Crystalfontz128x128_BeginWrite(s_lcdRun.x, s_lcdRun.y, s_lcdRun.x + count - 1, s_lcdRun.y);
+
+    HAL_LCD_writeBuffer16(s_lcdRun.pixels, count);
+}
+
+
+//*****************************************************************************
+//
+// Adds a pixel to the pending run if it is next to the last one, right of it
+// or below it, and otherwise sends the run and starts a new one with it.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_AddToRun(int16_t x, int16_t y, uint16_t value)
+{
+    uint16_t count = s_lcdRun.count;
+    bool extends = false;
+
+    if (count == 1)
+    {
+        s_lcdRun.vertical = (x == s_lcdRun.x && y == s_lcdRun.y + 1);
+        extends = s_lcdRun.vertical || (y == s_lcdRun.y && x == s_lcdRun.x + 1);
+    }
+    else if (count > 1)
+    {
+        extends = s_lcdRun.vertical ? (x == s_lcdRun.x && y == s_lcdRun.y + count)
+                                    : (y == s_lcdRun.y && x == s_lcdRun.x + count);
+    }
+
+    if (!extends)
+    {
+        Crystalfontz128x128_FlushRun();
+
+        s_lcdRun.x = x;
+        s_lcdRun.y = y;
+        s_lcdRun.vertical = false;
+    }
+
+    s_lcdRun.pixels[s_lcdRun.count++] = value;
+
+    if (s_lcdRun.count == LCD_RUN_PIXELS)
+        Crystalfontz128x128_FlushRun();
 }
+#endif
 
 
 //*****************************************************************************
@@ -173,6 +411,14 @@ void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1, uin
 //*****************************************************************************
 void Crystalfontz128x128_SetOrientation(uint8_t orientation)
 {
+    // Pixels drawn before belong to the old orientation
+    LCD_FLUSH_RUN();
+
+#ifdef LCD_SHADOW_BUFFER
+    // The LCD keeps its contents, but they now mean different pixels
+    LcdShadow_invalidate();
+#endif
+
     Lcd_Orientation = orientation;
     HAL_LCD_writeCommand(CM_MADCTL);
     switch (Lcd_Orientation) {
@@ -213,15 +459,23 @@ static void Crystalfontz128x128_PixelDraw(const Graphics_Display *pDisplay,
                                           int16_t lY,
                                           uint16_t ulValue)
 {
+    PROFILE_BEGIN(PROFILE_LCD_PIXEL_DRAW);
 
-    Crystalfontz128x128_SetDrawFrame(lX,lY,lX,lY);
+#ifdef LCD_SHADOW_BUFFER
+    LcdShadow_fill(lX, lY, lX, lY, ulValue);
+#elif defined(LCD_PIXEL_RUNS)
+    Crystalfontz128x128_AddToRun(lX, lY, ulValue);
+#else
+    Crystalfontz128x128_BeginWrite(lX,lY,lX,lY);
 
     //
     // Write the pixel value.
     //
-    HAL_LCD_writeCommand(CM_RAMWR);
     HAL_LCD_writeData(ulValue>>8);
     HAL_LCD_writeData(ulValue);
+#endif
+
+    PROFILE_END(PROFILE_LCD_PIXEL_DRAW);
 }
 
 
@@ -260,12 +514,18 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                                                   const uint32_t *pucPalette)
 {
     uint16_t Data;
+    uint32_t ulLinePixels = 0;
+
+    PROFILE_BEGIN(PROFILE_LCD_PIXEL_DRAW_MULTIPLE);
+
+#ifndef LCD_SHADOW_BUFFER
+    LCD_FLUSH_RUN();
 
     //
     // Set the cursor increment to left to right, followed by top to bottom.
     //
-    Crystalfontz128x128_SetDrawFrame(lX,lY,lX+lCount,127);
-    HAL_LCD_writeCommand(CM_RAMWR);
+    Crystalfontz128x128_BeginWrite(lX,lY,lX+lCount-1,lY);
+#endif
 
     //
     // Determine how to interpret the pixel data based on the number of bits
@@ -286,10 +546,8 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                 for(; (lX0 < 8) && lCount; lX0++, lCount--)
                 {
                     // Draw this pixel in the appropriate color
-                    HAL_LCD_writeData((((uint32_t *)pucPalette)[(Data >>
-                                                             (7 - lX0)) & 1])>>8);
-                    HAL_LCD_writeData(((uint32_t *)pucPalette)[(Data >>
-                                                             (7 - lX0)) & 1]);
+                    LCD_LINE_PUT(((uint32_t *)pucPalette)[(Data >>
+                                                       (7 - lX0)) & 1]);
                 }
 
                 // Start at the beginning of the next byte of image data
@@ -321,8 +579,7 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                         Data = (*pucData >> 4);
                         Data = (*(uint16_t *)(pucPalette + Data));
                         // Write to LCD screen
-                        HAL_LCD_writeData(Data>>8);
-                        HAL_LCD_writeData(Data);
+                        LCD_LINE_PUT(Data);
 
                         // Decrement the count of pixels to draw
                         lCount--;
@@ -337,8 +594,7 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                             Data = (*pucData++ & 15);
                             Data = (*(uint16_t *)(pucPalette + Data));
                             // Write to LCD screen
-                            HAL_LCD_writeData(Data>>8);
-                            HAL_LCD_writeData(Data);
+                            LCD_LINE_PUT(Data);
 
                             // Decrement the count of pixels to draw
                             lCount--;
@@ -361,8 +617,7 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                 Data = *pucData++;
                 Data = (*(uint16_t *)(pucPalette + Data));
                 // Write to LCD screen
-                HAL_LCD_writeData(Data>>8);
-                HAL_LCD_writeData(Data);
+                LCD_LINE_PUT(Data);
             }
             // The image data has been drawn
             break;
@@ -376,23 +631,16 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
         //
         case 16:
         {
-            uint16_t usData;
-
-            // Loop while there are more pixels to draw.
-
-            while(lCount--)
-            {
-                // Get the next byte of pixel data and extract the
-                // corresponding entry from the palette
-                usData = *((uint16_t *)pucData);
-                pucData += 2;
-
-                // Translate this palette entry and write it to the screen
-                HAL_LCD_writeData(usData>>8);
-                HAL_LCD_writeData(usData);
-            }
+            // The pixels need no translating, so stream them as they are
+            LCD_LINE_SEND((const uint16_t *)pucData, lCount);
         }
     }
+
+    // Send whatever is left of the line
+    if (ulLinePixels)
+        LCD_LINE_SEND(s_lcdLine, ulLinePixels);
+
+    PROFILE_END(PROFILE_LCD_PIXEL_DRAW_MULTIPLE);
 }
 
 
@@ -419,20 +667,21 @@ static void Crystalfontz128x128_LineDrawH(const Graphics_Display *pDisplay,
                                           int16_t lY,
                                           uint16_t ulValue)
 {
+    PROFILE_BEGIN(PROFILE_LCD_LINE_DRAW_H);
 
-
-    Crystalfontz128x128_SetDrawFrame(lX1, lY, lX2, lY);
+#ifdef LCD_SHADOW_BUFFER
+    LcdShadow_fill(lX1, lY, lX2, lY, ulValue);
+#else
+    LCD_FLUSH_RUN();
+    Crystalfontz128x128_BeginWrite(lX1, lY, lX2, lY);
 
     //
     // Write the pixel value.
     //
-    int16_t i;
-    HAL_LCD_writeCommand(CM_RAMWR);
-    for (i = lX1; i <= lX2; i++)
-    {
-        HAL_LCD_writeData(ulValue>>8);
-        HAL_LCD_writeData(ulValue);
-    }
+    HAL_LCD_writeRepeat16(ulValue, lX2 - lX1 + 1);
+#endif
+
+    PROFILE_END(PROFILE_LCD_LINE_DRAW_H);
 }
 
 
@@ -459,18 +708,21 @@ static void Crystalfontz128x128_LineDrawV(const Graphics_Display *pDisplay,
                                           int16_t lY2,
                                           uint16_t ulValue)
 {
-    Crystalfontz128x128_SetDrawFrame(lX, lY1, lX, lY2);
+    PROFILE_BEGIN(PROFILE_LCD_LINE_DRAW_V);
+
+#ifdef LCD_SHADOW_BUFFER
+    LcdShadow_fill(lX, lY1, lX, lY2, ulValue);
+#else
+    LCD_FLUSH_RUN();
+    Crystalfontz128x128_BeginWrite(lX, lY1, lX, lY2);
 
     //
     // Write the pixel value.
     //
-    int16_t i;
-    HAL_LCD_writeCommand(CM_RAMWR);
-    for (i = lY1; i <= lY2; i++)
-    {
-        HAL_LCD_writeData(ulValue>>8);
-        HAL_LCD_writeData(ulValue);
-    }
+    HAL_LCD_writeRepeat16(ulValue, lY2 - lY1 + 1);
+#endif
+
+    PROFILE_END(PROFILE_LCD_LINE_DRAW_V);
 }
 
 
@@ -500,19 +752,23 @@ static void Crystalfontz128x128_RectFill(const Graphics_Display *pDisplay,
     int16_t y0 = pRect->sYMin;
     int16_t y1 = pRect->sYMax;
 
-    Crystalfontz128x128_SetDrawFrame(x0, y0, x1, y1);
+    PROFILE_BEGIN(PROFILE_LCD_RECT_FILL);
+
+#ifdef LCD_SHADOW_BUFFER
+    LcdShadow_fill(x0, y0, x1, y1, ulValue);
+#else
+    LCD_FLUSH_RUN();
+    Crystalfontz128x128_BeginWrite(x0, y0, x1, y1);
 
     //
-    // Write the pixel value.
+    // Write the pixel value. The uDMA streams it in the background, so a full
+    // screen clear no longer keeps the CPU busy.
     //
-    int16_t i;
-    int16_t pixels = (x1 - x0 + 1) * (y1 - y0 + 1);
-    HAL_LCD_writeCommand(CM_RAMWR);
-    for (i = 0; i <= pixels; i++)
-    {
-        HAL_LCD_writeData(ulValue>>8);
-        HAL_LCD_writeData(ulValue);
-    }
+    uint32_t pixels = (uint32_t) (x1 - x0 + 1) * (y1 - y0 + 1);
+    HAL_LCD_writeRepeat16(ulValue, pixels);
+#endif
+
+    PROFILE_END(PROFILE_LCD_RECT_FILL);
 }
 
 //*****************************************************************************
@@ -553,8 +809,9 @@ static uint32_t Crystalfontz128x128_ColorTranslate(const Graphics_Display *pDisp
 //!
 //! This functions flushes any cached drawing operations to the display.  This
 //! is useful when a local frame buffer is used for drawing operations, and the
-//! flush would copy the local frame buffer to the display.  For the SSD2119
-//! driver, the flush is a no operation.
+//! flush would copy the local frame buffer to the display.  Without
+//! LCD_SHADOW_BUFFER, every drawing operation goes straight to the display,
+//! except for the last run of pixels with LCD_PIXEL_RUNS, which is sent here.
 //!
 //! \return None.
 //
@@ -562,9 +819,14 @@ static uint32_t Crystalfontz128x128_ColorTranslate(const Graphics_Display *pDisp
 static void
 Crystalfontz128x128_Flush(const Graphics_Display *pDisplay)
 {
+    LCD_FLUSH_RUN();
+
+#ifdef LCD_SHADOW_BUFFER
     //
-    // There is nothing to be done.
+    // Send every rectangle drawn into since the last flush.
     //
+    LcdShadow_flush();
+#endif
 }
 
 
@@ -616,3 +878,93 @@ const Graphics_Display_Functions g_sCrystalfontz128x128_funcs =
     Crystalfontz128x128_ClearScreen
 
 };
+
+
+#ifdef LCD_BENCHMARK
+
+//*****************************************************************************
+//
+// Bytes sent by each pass of the benchmark: one full screen of 5-6-5 pixels.
+// The color has different high and low bytes, so the uDMA pass has to repeat
+// its pattern buffer rather than a single fixed byte.
+//
+//*****************************************************************************
+#define LCD_BENCHMARK_PIXELS    (LCD_HORIZONTAL_MAX * LCD_VERTICAL_MAX)
+#define LCD_BENCHMARK_BYTES     (LCD_BENCHMARK_PIXELS * 2)
+#define LCD_BENCHMARK_COLOR     0x1234
+
+static uint32_t Crystalfontz128x128_BytesPerSecond(uint64_t start)
+{
+    HAL_LCD_waitIdle();
+
+    uint64_t elapsed = Clock_now() - start;
+    return (uint64_t) LCD_BENCHMARK_BYTES * CLOCK_TICKS_PER_SECOND / elapsed;
+}
+
+//*****************************************************************************
+//
+//! Measures how fast each way of writing pixel data reaches the LCD.
+//!
+//! Fills the whole screen four times: a byte at a time through
+//! HAL_LCD_writeData(), a line at a time through HAL_LCD_writeBuffer16(), all
+//! at once through HAL_LCD_writeRepeat16(), and a pixel at a time through the
+//! PixelDraw primitive, as text is drawn. Each pass is timed with Clock_now()
+//! from its first write until the eUSCI has shifted out its last byte, so it
+//! measures the throughput actually reached on the SPI. The line written by
+//! the second pass is PixelDrawMultiple's line buffer, which is free while
+//! nothing else is being drawn.
+//!
+//! \return the throughput of each pass, in bytes of pixel data per second.
+//
+//*****************************************************************************
+Crystalfontz128x128_Benchmark Crystalfontz128x128_benchmark(void)
+{
+    Crystalfontz128x128_Benchmark benchmark;
+    uint64_t start;
+    uint32_t i;
+
+    for (i = 0; i < LCD_LINE_PIXELS; i++)
+        s_lcdLine[i] = LCD_BENCHMARK_COLOR;
+
+    Crystalfontz128x128_SetDrawFrame(0, 0, LCD_HORIZONTAL_MAX - 1, LCD_VERTICAL_MAX - 1);
+    HAL_LCD_writeCommand(CM_RAMWR);
+    HAL_LCD_waitIdle();
+
+    start = Clock_now();
+    for (i = 0; i < LCD_BENCHMARK_PIXELS; i++)
+    {
+        HAL_LCD_writeData(LCD_BENCHMARK_COLOR >> 8);
+        HAL_LCD_writeData(LCD_BENCHMARK_COLOR & 0xFF);
+    }
+    benchmark.perByte = Crystalfontz128x128_BytesPerSecond(start);
+
+    HAL_LCD_writeCommand(CM_RAMWR);
+    HAL_LCD_waitIdle();
+
+    start = Clock_now();
+    for (i = 0; i < LCD_VERTICAL_MAX; i++)
+        HAL_LCD_writeBuffer16(s_lcdLine, LCD_LINE_PIXELS);
+    benchmark.buffer16 = Crystalfontz128x128_BytesPerSecond(start);
+
+    HAL_LCD_writeCommand(CM_RAMWR);
+    HAL_LCD_waitIdle();
+
+    start = Clock_now();
+    HAL_LCD_writeRepeat16(LCD_BENCHMARK_COLOR, LCD_BENCHMARK_PIXELS);
+    benchmark.repeat16 = Crystalfontz128x128_BytesPerSecond(start);
+
+    int16_t x, y;
+
+    start = Clock_now();
+    for (y = 0; y < LCD_VERTICAL_MAX; y++)
+    {
+        for (x = 0; x < LCD_HORIZONTAL_MAX; x++)
+            Crystalfontz128x128_PixelDraw(&g_sCrystalfontz128x128, x, y, ~LCD_BENCHMARK_COLOR);
+    }
+    Crystalfontz128x128_Flush(&g_sCrystalfontz128x128);
+    benchmark.pixelDraw = Crystalfontz128x128_BytesPerSecond(start);
+
+    return benchmark;
+}
+
+#endif
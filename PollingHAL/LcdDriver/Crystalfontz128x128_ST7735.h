@@ -99,6 +99,10 @@ extern uint16_t Lcd_TouchTrim;
 
 extern Graphics_Display g_sCrystalfontz128x128;
 
+// The drawing primitives grlib calls. With LCD_PIXEL_RUNS defined, pixels drawn one at a time by
+// PixelDraw are held back and sent as runs along a row or down a column. The last run only reaches
+// the LCD when something else is drawn or on Flush, through Graphics_flushBuffer(), so flush once a
+// frame is drawn, as with LCD_SHADOW_BUFFER.
 extern const Graphics_Display_Functions g_sCrystalfontz128x128_funcs;
 
 extern void Crystalfontz128x128_Init(void);
@@ -107,6 +111,22 @@ extern void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t
 
 extern void Crystalfontz128x128_SetOrientation(uint8_t orientation);
 
+#ifdef LCD_BENCHMARK
+// Throughput of each way of writing pixel data to the LCD, in bytes per second, measured by
+// filling the whole screen once with each. Build with LCD_BENCHMARK defined, and call it after
+// Crystalfontz128x128_Init() with interrupts enabled. It leaves the screen filled with a color.
+struct _Crystalfontz128x128_Benchmark
+{
+    uint32_t perByte;       // HAL_LCD_writeData(), through the transmit queue
+    uint32_t buffer16;      // HAL_LCD_writeBuffer16(), a line at a time, streamed by the CPU
+    uint32_t repeat16;      // HAL_LCD_writeRepeat16(), in one go, by the uDMA
+    uint32_t pixelDraw;     // The PixelDraw primitive, one pixel at a time
+};
+typedef struct _Crystalfontz128x128_Benchmark Crystalfontz128x128_Benchmark;
+
+extern Crystalfontz128x128_Benchmark Crystalfontz128x128_benchmark(void);
+#endif
+
 
 
 #endif /* __CRYSTALFONTZLCD_H__ */
@@ -40,8 +40,101 @@
 #include <PollingHAL/LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h>
 #include <ti/grlib/grlib.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <PollingHAL/SWTimer.h>
+#include <InterruptHAL.h>
+#include <Profiler.h>
 #include <stdint.h>
 
+//*****************************************************************************
+//
+// The transmit queue. Commands and data bytes are queued by the main
+// application and fed to the eUSCI by its transmit interrupt, so that writing
+// to the LCD never waits for the SPI unless the queue is full. Each entry is a
+// byte, plus LCD_QUEUE_COMMAND if it must be sent with DC low. The interrupt
+// only has to wait for the SPI when DC changes, since the byte in the shifter
+// must finish at the old level.
+//
+//*****************************************************************************
+#define LCD_QUEUE_CAPACITY      256
+#define LCD_QUEUE_MASK          (LCD_QUEUE_CAPACITY - 1)
+#define LCD_QUEUE_COMMAND       0x0100
+
+struct _LcdQueue
+{
+    uint16_t entries[LCD_QUEUE_CAPACITY];
+    volatile uint16_t head;     // Next entry to send, only written by the ISR
+    volatile uint16_t tail;     // Next free entry, only written by producers
+
+    bool command;               // Whether DC is low right now
+    volatile bool running;      // Whether the transmit interrupt is enabled
+    bool suspended;             // Whether the eUSCI is held for a clock change
+
+    uint32_t commands;          // Commands written so far, see HAL_LCD_commandCount()
+};
+typedef struct _LcdQueue LcdQueue;
+
+static LcdQueue s_lcdQueue;
+
+//*****************************************************************************
+//
+// uDMA transfers to the LCD. The uDMA moves at most LCD_DMA_MAX_ITEMS bytes per
+// transfer, so longer writes are split up, and the DMA interrupt starts each
+// part as soon as the one before it is done. A fill whose color has the same
+// high and low byte (black and white, for example) is sent from a single fixed
+// source byte. Any other color is repeated from a small pattern buffer instead,
+// since the SPI takes one byte at a time and the uDMA cannot alternate between
+// two fixed bytes.
+//
+//*****************************************************************************
+#define LCD_DMA_MAX_ITEMS       1024
+#define LCD_DMA_PATTERN_BYTES   256
+
+// Writes shorter than this are streamed by the CPU, since setting up the uDMA
+// would take longer than sending the bytes.
+#define LCD_DMA_MIN_BYTES       16
+
+// Streams one byte of data by the CPU: waits only until the transmit buffer is
+// free, not until the SPI is idle, so the next byte is always ready to go as
+// soon as the shifter takes the last one.
+#define LCD_STREAM_BYTE(byte)                                                   \
+    do                                                                          \
+    {                                                                           \
+        while (!(UCB0IFG & UCTXIFG));                                           \
+        UCB0TXBUF = (byte);                                                     \
+    } while (0)
+
+enum _LcdDmaSource
+{
+    LCD_DMA_SOURCE_FIXED,       // Every byte comes from [fillByte]
+    LCD_DMA_SOURCE_PATTERN,     // Each part starts over at [pattern]
+    LCD_DMA_SOURCE_BUFFER       // Each part continues where the last one ended
+};
+typedef enum _LcdDmaSource LcdDmaSource;
+
+struct _LcdDma
+{
+    LcdDmaSource source;
+    const uint8_t* next;        // Where the next part is read from
+    uint32_t remaining;         // Bytes left after the current part
+    volatile bool busy;         // Cleared by the DMA interrupt at the end
+
+    uint8_t fillByte;
+    uint8_t pattern[LCD_DMA_PATTERN_BYTES];
+};
+typedef struct _LcdDma LcdDma;
+
+static LcdDma s_lcdDma;
+
+// The uDMA control table must be aligned to its own size. Only the primary
+// control structure of LCD_DMA_CHANNEL is used, but the table covers all eight
+// channels, so other modules can share it.
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(s_dmaControlTable, 256)
+static uint8_t s_dmaControlTable[256];
+#else
+static uint8_t s_dmaControlTable[256] __attribute__((aligned(256)));
+#endif
+
 void HAL_LCD_PortInit(void)
 {
     // LCD_SCK
@@ -56,20 +149,317 @@ void HAL_LCD_PortInit(void)
     GPIO_setAsOutputPin(LCD_CS_PORT, LCD_CS_PIN);
 }
 
-void HAL_LCD_SpiInit(void)
+//*****************************************************************************
+//
+// Configures the SPI module for the current SMCLK speed. Called once from
+// HAL_LCD_SpiInit(), and again after every system clock frequency change so
+// that the SPI clock divider follows SMCLK. Nothing may be sent while it runs,
+// since SPI_initMaster() resets the eUSCI.
+//
+//*****************************************************************************
+static void HAL_LCD_SpiConfigure(void)
 {
     eUSCI_SPI_MasterConfig config =
         {
             EUSCI_B_SPI_CLOCKSOURCE_SMCLK,
-            LCD_SYSTEM_CLOCK_SPEED,
+            Clock_peripheralFrequency(),
             LCD_SPI_CLOCK_SPEED,
             EUSCI_B_SPI_MSB_FIRST,
             EUSCI_B_SPI_PHASE_DATA_CAPTURED_ONFIRST_CHANGED_ON_NEXT,
             EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_LOW,
             EUSCI_B_SPI_3PIN
         };
+
     SPI_initMaster(LCD_EUSCI_BASE, &config);
     SPI_enableModule(LCD_EUSCI_BASE);
+    SPI_enableInterrupt(LCD_EUSCI_BASE, EUSCI_B_SPI_TRANSMIT_INTERRUPT);
+}
+
+//*****************************************************************************
+//
+// Invoked whenever the eUSCI's transmit buffer is empty while the queue is
+// running. Keeps the buffer filled for as long as there are queued bytes, and
+// turns itself off once the queue is empty. The interrupt is only enabled in
+// the NVIC while there is something to send, so the idle governor can still
+// pick deep sleep whenever the LCD is idle. Its run time is accounted for as
+// ISR_SOURCE_LCD_SPI in the InterruptHAL power stats.
+//
+//*****************************************************************************
+static void HAL_LCD_QueueIsr(void)
+{
+    uint64_t now = Clock_now();
+
+    while ((UCB0IFG & UCTXIFG) && (s_lcdQueue.head != s_lcdQueue.tail))
+    {
+        uint16_t entry = s_lcdQueue.entries[s_lcdQueue.head & LCD_QUEUE_MASK];
+        bool command = (entry & LCD_QUEUE_COMMAND) != 0;
+
+        if (command != s_lcdQueue.command)
+        {
+            while (UCB0STATW & UCBUSY);
+
+            if (command)
+                GPIO_setOutputLowOnPin(LCD_DC_PORT, LCD_DC_PIN);
+            else
+                GPIO_setOutputHighOnPin(LCD_DC_PORT, LCD_DC_PIN);
+
+            s_lcdQueue.command = command;
+        }
+
+        UCB0TXBUF = (uint8_t) entry;
+        s_lcdQueue.head++;
+    }
+
+    if (s_lcdQueue.head == s_lcdQueue.tail)
+    {
+        s_lcdQueue.running = false;
+        Interrupt_disableInterrupt(LCD_QUEUE_NVIC);
+    }
+
+    InterruptHal_LogIsrTime(ISR_SOURCE_LCD_SPI, now);
+}
+
+//*****************************************************************************
+//
+// Starts the transmit interrupt if it is not running already. A uDMA transfer
+// owns the eUSCI until it is done, so while one is running, the DMA interrupt
+// starts the queue once the transfer finishes instead. While the eUSCI is held
+// for a clock change, HAL_LCD_SpiResume() starts it afterwards.
+//
+//*****************************************************************************
+static void HAL_LCD_QueueStart(void)
+{
+    if (!s_lcdQueue.running && !s_lcdDma.busy && !s_lcdQueue.suspended)
+    {
+        s_lcdQueue.running = true;
+        Interrupt_enableInterrupt(LCD_QUEUE_NVIC);
+    }
+}
+
+static bool HAL_LCD_QueueFull(void)
+{
+    return (uint16_t) (s_lcdQueue.tail - s_lcdQueue.head) == LCD_QUEUE_CAPACITY;
+}
+
+static bool HAL_LCD_Transferring(void)
+{
+    return s_lcdDma.busy || (s_lcdQueue.head != s_lcdQueue.tail);
+}
+
+//*****************************************************************************
+//
+// Sleeps in LPM0 for as long as [condition] holds, which only the LCD's
+// interrupts can change. Checking and sleeping happen with interrupts masked,
+// as in SleepProcessor(), so the interrupt which ends the wait cannot slip in
+// between them and leave us asleep.
+//
+//*****************************************************************************
+static void HAL_LCD_SleepWhile(bool (*condition)(void))
+{
+    if (!condition())
+        return;
+
+    Interrupt_disableMaster();
+
+    while (condition())
+    {
+        PCM_gotoLPM0();
+        Interrupt_enableMaster();
+        Interrupt_disableMaster();
+    }
+
+    Interrupt_enableMaster();
+}
+
+//*****************************************************************************
+//
+// Adds a byte to the transmit queue, sleeping until there is room if the queue
+// is full, and makes sure the queue is running.
+//
+//*****************************************************************************
+static void HAL_LCD_QueuePush(uint16_t entry)
+{
+    HAL_LCD_SleepWhile(HAL_LCD_QueueFull);
+
+    s_lcdQueue.entries[s_lcdQueue.tail & LCD_QUEUE_MASK] = entry;
+    s_lcdQueue.tail++;
+
+    HAL_LCD_QueueStart();
+}
+
+//*****************************************************************************
+//
+// Starts the next part of the current uDMA transfer, of at most
+// LCD_DMA_MAX_ITEMS bytes (or one pattern buffer). The eUSCI requests a byte
+// whenever its transmit buffer is empty, which it already is, so the part
+// starts as soon as the channel is enabled.
+//
+//*****************************************************************************
+static void HAL_LCD_DmaStartPart(void)
+{
+    uint32_t limit = (s_lcdDma.source == LCD_DMA_SOURCE_PATTERN)
+                   ? LCD_DMA_PATTERN_BYTES : LCD_DMA_MAX_ITEMS;
+    uint32_t length = (s_lcdDma.remaining < limit) ? s_lcdDma.remaining : limit;
+
+    DMA_setChannelTransfer(UDMA_PRI_SELECT | LCD_DMA_CHANNEL, UDMA_MODE_BASIC,
+                           (void*) s_lcdDma.next,
+                           (void*) SPI_getTransmitBufferAddressForDMA(LCD_EUSCI_BASE),
+                           length);
+
+    if (s_lcdDma.source == LCD_DMA_SOURCE_BUFFER)
+        s_lcdDma.next += length;
+
+    s_lcdDma.remaining -= length;
+    DMA_enableChannel(LCD_DMA_CHANNEL_NUM);
+}
+
+//*****************************************************************************
+//
+// Invoked whenever a part of a uDMA transfer to the LCD is done. Starts the
+// next part, or marks the whole transfer as done and stops listening to the
+// DMA interrupt, which also lets the idle governor pick deep sleep again. Its
+// run time is accounted for as ISR_SOURCE_LCD_DMA in the InterruptHAL power
+// stats.
+//
+//*****************************************************************************
+static void HAL_LCD_DmaIsr(void)
+{
+    uint64_t now = Clock_now();
+
+    DMA_clearInterruptFlag(LCD_DMA_CHANNEL_NUM);
+
+    if (s_lcdDma.remaining > 0)
+    {
+        HAL_LCD_DmaStartPart();
+    }
+    else
+    {
+        Interrupt_disableInterrupt(LCD_DMA_NVIC);
+        s_lcdDma.busy = false;
+
+        // Bytes queued during the transfer have been waiting for it
+        if (s_lcdQueue.head != s_lcdQueue.tail)
+            HAL_LCD_QueueStart();
+    }
+
+    InterruptHal_LogIsrTime(ISR_SOURCE_LCD_DMA, now);
+}
+
+//*****************************************************************************
+//
+// Gets the eUSCI ready for the CPU to stream data into it: everything queued
+// before is sent first, and DC is set for data. After this, nothing but data
+// bytes may be written until the stream is over, which it is as soon as the
+// last byte is in the transmit buffer.
+//
+//*****************************************************************************
+static void HAL_LCD_StreamBegin(void)
+{
+    HAL_LCD_waitIdle();
+
+    if (s_lcdQueue.command)
+    {
+        GPIO_setOutputHighOnPin(LCD_DC_PORT, LCD_DC_PIN);
+        s_lcdQueue.command = false;
+    }
+}
+
+//*****************************************************************************
+//
+// Starts a uDMA transfer of [length] bytes of data to the LCD, whose first byte
+// is at [source], and returns right away. Everything queued before it is sent
+// first, so that the transfer has the eUSCI to itself.
+//
+//*****************************************************************************
+static void HAL_LCD_DmaStart(LcdDmaSource source, const uint8_t* data, uint32_t length)
+{
+    HAL_LCD_StreamBegin();
+
+    uint32_t increment = (source == LCD_DMA_SOURCE_FIXED) ? UDMA_SRC_INC_NONE : UDMA_SRC_INC_8;
+    DMA_setChannelControl(UDMA_PRI_SELECT | LCD_DMA_CHANNEL,
+                          UDMA_SIZE_8 | increment | UDMA_DST_INC_NONE | UDMA_ARB_1);
+
+    s_lcdDma.source = source;
+    s_lcdDma.next = data;
+    s_lcdDma.remaining = length;
+    s_lcdDma.busy = true;
+
+    DMA_clearInterruptFlag(LCD_DMA_CHANNEL_NUM);
+    Interrupt_enableInterrupt(LCD_DMA_NVIC);
+    HAL_LCD_DmaStartPart();
+}
+
+//*****************************************************************************
+//
+// Hands the uDMA its control table and routes LCD_DMA_CHANNEL to the transmit
+// buffer of LCD_EUSCI_BASE. The DMA interrupt is only enabled in the NVIC
+// while a transfer is running.
+//
+//*****************************************************************************
+static void HAL_LCD_DmaInit(void)
+{
+    s_lcdDma.busy = false;
+
+    DMA_enableModule();
+    DMA_setControlBase(s_dmaControlTable);
+
+    DMA_assignChannel(LCD_DMA_CHANNEL);
+    DMA_disableChannelAttribute(LCD_DMA_CHANNEL, UDMA_ATTR_ALTSELECT | UDMA_ATTR_USEBURST
+                                               | UDMA_ATTR_HIGH_PRIORITY | UDMA_ATTR_REQMASK);
+
+    DMA_assignInterrupt(LCD_DMA_INTERRUPT, LCD_DMA_CHANNEL_NUM);
+    DMA_registerInterrupt(LCD_DMA_INTERRUPT, HAL_LCD_DmaIsr);
+    Interrupt_disableInterrupt(LCD_DMA_NVIC);
+}
+
+//*****************************************************************************
+//
+// Called before every system clock frequency change. A uDMA transfer or queued
+// bytes still going out once SMCLK changes would be sent at the wrong SPI
+// clock, so the queue is drained at the old frequency first. Its interrupt then
+// stays off until HAL_LCD_SpiResume(), so that the eUSCI is not fed while it is
+// reset and reconfigured.
+//
+//*****************************************************************************
+static void HAL_LCD_SpiSuspend(void)
+{
+    HAL_LCD_waitIdle();
+
+    Interrupt_disableInterrupt(LCD_QUEUE_NVIC);
+    s_lcdQueue.running = false;
+    s_lcdQueue.suspended = true;
+}
+
+//*****************************************************************************
+//
+// Called after every system clock frequency change. Reconfigures the SPI for
+// the new SMCLK, then lets the queue run again.
+//
+//*****************************************************************************
+static void HAL_LCD_SpiResume(void)
+{
+    HAL_LCD_SpiConfigure();
+
+    s_lcdQueue.suspended = false;
+    if (s_lcdQueue.head != s_lcdQueue.tail)
+        HAL_LCD_QueueStart();
+}
+
+void HAL_LCD_SpiInit(void)
+{
+    s_lcdQueue.head = 0;
+    s_lcdQueue.tail = 0;
+    s_lcdQueue.command = false;
+    s_lcdQueue.running = false;
+    s_lcdQueue.suspended = false;
+    s_lcdQueue.commands = 0;
+
+    HAL_LCD_DmaInit();
+    HAL_LCD_SpiConfigure();
+    Clock_addFrequencyListener(HAL_LCD_SpiSuspend, HAL_LCD_SpiResume);
+
+    Interrupt_registerInterrupt(LCD_QUEUE_NVIC, HAL_LCD_QueueIsr);
+    Interrupt_disableInterrupt(LCD_QUEUE_NVIC);
 
     GPIO_setOutputLowOnPin(LCD_CS_PORT, LCD_CS_PIN);
 
@@ -79,96 +469,181 @@ void HAL_LCD_SpiInit(void)
 
 //*****************************************************************************
 //
-// Writes a command to the CFAF128128B-0145T.  This function implements the basic SPI
-// interface to the LCD display.
+// Busy-waits for the given number of milliseconds. The wait is measured with
+// a SWTimer rather than counted in CPU cycles, so it lasts just as long at any
+// system clock frequency. It starts once everything written so far has been
+// sent, since the delays the LCD needs are counted from its last command.
 //
 //*****************************************************************************
-void HAL_LCD_writeCommand(uint8_t command)
+void HAL_LCD_delay(uint32_t ms)
 {
-    // Set to command mode
-    GPIO_setOutputLowOnPin(LCD_DC_PORT, LCD_DC_PIN);
+    HAL_LCD_waitIdle();
 
-    // USCI_B0 Busy? //
-    while (UCB0STATW & UCBUSY);
+    SWTimer timer = SWTimer_construct(ms);
+    SWTimer_start(&timer);
 
-    // Transmit data
-    UCB0TXBUF = command;
+    while (!SWTimer_expired(&timer));
+}
 
-    // USCI_B0 Busy? //
-    while (UCB0STATW & UCBUSY);
 
-    // Set back to data mode
-    GPIO_setOutputHighOnPin(LCD_DC_PORT, LCD_DC_PIN);
+//*****************************************************************************
+//
+// Writes a command to the CFAF128128B-0145T.  This function implements the basic SPI
+// interface to the LCD display. The command is queued and sent with DC low by the
+// transmit interrupt, so this returns right away unless the queue is full.
+//
+//*****************************************************************************
+void HAL_LCD_writeCommand(uint8_t command)
+{
+    PROFILE_BEGIN(PROFILE_LCD_WRITE_COMMAND);
+
+    s_lcdQueue.commands++;
+    HAL_LCD_QueuePush(LCD_QUEUE_COMMAND | command);
+
+    PROFILE_END(PROFILE_LCD_WRITE_COMMAND);
 }
 
 
 //*****************************************************************************
 //
 // Writes a data to the CFAF128128B-0145T.  This function implements the basic SPI
-// interface to the LCD display.
+// interface to the LCD display. Like commands, data is queued and this returns
+// right away unless the queue is full.
 //
 //*****************************************************************************
 void HAL_LCD_writeData(uint8_t data)
 {
-    // USCI_B0 Busy? //
-    while (UCB0STATW & UCBUSY);
+    PROFILE_BEGIN(PROFILE_LCD_WRITE_DATA);
 
-    // Transmit data
-    UCB0TXBUF = data;
+    HAL_LCD_QueuePush(data);
 
-    // USCI_B0 Busy? //
-    while (UCB0STATW & UCBUSY);
+    PROFILE_END(PROFILE_LCD_WRITE_DATA);
 }
 
+
 //*****************************************************************************
 //
-//! Provides a small delay.
-//!
-//! \param ui32Count is the number of delay loop iterations to perform.
-//!
-//! This function provides a means of generating a delay by executing a simple
-//! 3 instruction cycle loop a given number of times.  It is written in
-//! assembly to keep the loop instruction count consistent across tool chains.
-//!
-//! It is important to note that this function does NOT provide an accurate
-//! timing mechanism.  Although the delay loop is 3 instruction cycles long,
-//! the execution time of the loop will vary dramatically depending upon the
-//! application's interrupt environment (the loop will be interrupted unless
-//! run with interrupts disabled and this is generally an unwise thing to do)
-//! and also the current system clock rate and flash timings (wait states and
-//! the operation of the prefetch buffer affect the timing).
-//!
-//! For best accuracy, a system timer should be used with code either polling
-//! for a particular timer value being exceeded or processing the timer
-//! interrupt to determine when a particular time period has elapsed.
-//!
-//! \return None.
+// Sends [count] copies of a 5-6-5 color to the LCD. Short runs are streamed by
+// the CPU, and longer ones by the uDMA, in the background.
 //
 //*****************************************************************************
-#if defined( __ICCARM__ ) || defined(DOXYGEN)
-void
-SysCtlDelay(uint32_t ui32Count)
+void HAL_LCD_writeRepeat16(uint16_t color, uint32_t count)
 {
-    __asm("    subs    r0, #1\n"
-          "    bne.n   SysCtlDelay\n"
-          "    bx      lr");
+    uint8_t high = color >> 8;
+    uint8_t low = color;
+
+    if (count * 2 < LCD_DMA_MIN_BYTES)
+    {
+        HAL_LCD_StreamBegin();
+
+        while (count--)
+        {
+            LCD_STREAM_BYTE(high);
+            LCD_STREAM_BYTE(low);
+        }
+        return;
+    }
+
+    // The current transfer may still be reading the fill byte or the pattern
+    HAL_LCD_waitIdle();
+
+    if (high == low)
+    {
+        s_lcdDma.fillByte = high;
+        HAL_LCD_DmaStart(LCD_DMA_SOURCE_FIXED, &s_lcdDma.fillByte, count * 2);
+        return;
+    }
+
+    int i;
+    for (i = 0; i < LCD_DMA_PATTERN_BYTES; i += 2)
+    {
+        s_lcdDma.pattern[i] = high;
+        s_lcdDma.pattern[i + 1] = low;
+    }
+
+    HAL_LCD_DmaStart(LCD_DMA_SOURCE_PATTERN, s_lcdDma.pattern, count * 2);
 }
-#endif
-#if defined(codered) || defined( __GNUC__ ) || defined(sourcerygxx)
-void __attribute__((naked))
-SysCtlDelay(uint32_t ui32Count)
+
+
+//*****************************************************************************
+//
+// Sends [count] 5-6-5 pixels to the LCD, high byte first. The pixels are in
+// the processor's own (little-endian) byte order, which the uDMA cannot swap,
+// so the CPU streams them, and returns once the last byte is in the transmit
+// buffer.
+//
+//*****************************************************************************
+void HAL_LCD_writeBuffer16(const uint16_t* pixels, uint32_t count)
 {
-    __asm("    subs    r0, #1\n"
-          "    bne     SysCtlDelay\n"
-          "    bx      lr");
+    HAL_LCD_StreamBegin();
+
+    while (count--)
+    {
+        uint16_t pixel = *pixels++;
+
+        LCD_STREAM_BYTE(pixel >> 8);
+        LCD_STREAM_BYTE((uint8_t) pixel);
+    }
 }
-#endif
-#if defined(rvmdk) || defined( __CC_ARM )
-__asm void
-SysCtlDelay(uint32_t ui32Count)
+
+
+//*****************************************************************************
+//
+// Sends a buffer of bytes to the LCD as they are, in the background when it is
+// worth it.
+//
+//*****************************************************************************
+void HAL_LCD_writeDataBuffer(const uint8_t* data, uint32_t length)
+{
+    if (length < LCD_DMA_MIN_BYTES)
+    {
+        HAL_LCD_StreamBegin();
+
+        while (length--)
+            LCD_STREAM_BYTE(*data++);
+        return;
+    }
+
+    HAL_LCD_DmaStart(LCD_DMA_SOURCE_BUFFER, data, length);
+}
+
+
+//*****************************************************************************
+//
+// Returns how many commands have been written to the LCD so far. The count only
+// ever goes up, so comparing it with an earlier reading tells whether any
+// command has been written in between.
+//
+//*****************************************************************************
+uint32_t HAL_LCD_commandCount(void)
 {
-    subs    r0, #1;
-    bne     SysCtlDelay;
-    bx      lr;
+    return s_lcdQueue.commands;
+}
+
+
+//*****************************************************************************
+//
+// Returns whether queued bytes or a uDMA transfer are still waiting to be sent
+// to the LCD.
+//
+//*****************************************************************************
+bool HAL_LCD_busy(void)
+{
+    return HAL_LCD_Transferring();
+}
+
+
+//*****************************************************************************
+//
+// Flushes everything written to the LCD so far: waits until the queue is empty,
+// no uDMA transfer is running and the eUSCI has shifted out its last byte. The
+// CPU sleeps in LPM0 while the interrupts do the work, and only spins for the
+// last byte.
+//
+//*****************************************************************************
+void HAL_LCD_waitIdle(void)
+{
+    HAL_LCD_SleepWhile(HAL_LCD_Transferring);
+
+    while (UCB0STATW & UCBUSY);
 }
-#endif
@@ -42,6 +42,7 @@
 
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 //*****************************************************************************
 //
@@ -49,9 +50,8 @@
 //
 //*****************************************************************************
 
-// System clock speed (in Hz)
-#define LCD_SYSTEM_CLOCK_SPEED                 48000000
-// SPI clock speed (in Hz)
+// Fastest SPI clock speed (in Hz). The SPI clock is divided down from SMCLK, whose speed is taken
+// from Clock_peripheralFrequency() and followed whenever Clock_setSystemFrequency() changes it.
 #define LCD_SPI_CLOCK_SPEED                    16000000
 
 // Ports from MSP432 connected to LCD
@@ -73,23 +73,52 @@
 // Definition of USCI base address to be used for SPI communication
 #define LCD_EUSCI_BASE        EUSCI_B0_BASE
 
+// uDMA channel which feeds the transmit buffer of LCD_EUSCI_BASE, and the DMA interrupt which
+// signals the end of each transfer on it
+#define LCD_DMA_CHANNEL       DMA_CH0_EUSCIB0TX0
+#define LCD_DMA_CHANNEL_NUM   0
+#define LCD_DMA_INTERRUPT     DMA_INT1
+#define LCD_DMA_NVIC          INT_DMA_INT1
+
+// Interrupt of LCD_EUSCI_BASE, which feeds the transmit queue
+#define LCD_QUEUE_NVIC        INT_EUSCIB0
+
 //*****************************************************************************
 //
 // Prototypes for the globals exported by this driver.
 //
 //*****************************************************************************
+// Queue a command or data byte for the LCD and return right away. The bytes are sent in order
+// by the transmit interrupt, which also switches DC between commands and data. Only when the
+// queue is full does a write wait, sleeping in LPM0 until there is room.
 extern void HAL_LCD_writeCommand(uint8_t command);
 extern void HAL_LCD_writeData(uint8_t data);
+
+// The number of commands written so far, for telling whether any command has been written since
+// an earlier reading.
+extern uint32_t HAL_LCD_commandCount(void);
 extern void HAL_LCD_PortInit(void);
 extern void HAL_LCD_SpiInit(void);
 
-// Custom __delay_cycles() for non CCS Compiler
-#if !defined( __TI_ARM__ )
-#undef __delay_cycles
-#define __delay_cycles(x)     SysCtlDelay(x)
-void SysCtlDelay(uint32_t);
-#endif
+// Bulk writes of pixel data, which skip the queue: DC is set once, and the bytes go straight into
+// the transmit buffer as soon as it is free, without waiting for the SPI to go idle in between.
+// writeRepeat16() sends [count] copies of one 5-6-5 color, and writeBuffer16() sends [count]
+// 5-6-5 pixels, high byte first. writeDataBuffer() sends [length] bytes as they are, so [data]
+// must hold big-endian pixels and stay untouched until the transfer finishes. Long repeats and
+// byte buffers are sent by the uDMA, in the background: they return as soon as the transfer has
+// started, and the next write to the LCD waits for it to finish first. Short ones, and every
+// 16-bit buffer, are streamed by the CPU. Call these from the main application only.
+extern void HAL_LCD_writeRepeat16(uint16_t color, uint32_t count);
+extern void HAL_LCD_writeBuffer16(const uint16_t* pixels, uint32_t count);
+extern void HAL_LCD_writeDataBuffer(const uint8_t* data, uint32_t length);
+
+// Whether queued bytes or a uDMA transfer are still waiting to be sent to the LCD, and a flush
+// which waits until they have all been sent, keeping the CPU in LPM0 in the meantime. Never write
+// to the LCD or wait for it from an ISR or with interrupts masked.
+extern bool HAL_LCD_busy(void);
+extern void HAL_LCD_waitIdle(void);
 
-#define HAL_LCD_delay(x)      __delay_cycles(x * 48)
+// Waits for the given number of milliseconds, at any system clock frequency.
+extern void HAL_LCD_delay(uint32_t ms);
 
 #endif /* HAL_MSP_EXP432P401R_CRYSTALFONTZ128X128_ST7735_H_ */
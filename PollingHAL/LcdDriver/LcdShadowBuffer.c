@@ -0,0 +1,434 @@
+/*
+ * LcdShadowBuffer.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ */
+
+#include <PollingHAL/LcdDriver/LcdShadowBuffer.h>
+
+#ifdef LCD_SHADOW_BUFFER
+
+#include <PollingHAL/LcdDriver/Crystalfontz128x128_ST7735.h>
+#include <PollingHAL/LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define SHADOW_WIDTH                LCD_HORIZONTAL_MAX
+#define SHADOW_HEIGHT               LCD_VERTICAL_MAX
+#define SHADOW_BYTES                (SHADOW_WIDTH * SHADOW_HEIGHT \
+                                     * LCD_SHADOW_BPP / 8)
+
+/** A rectangle of the screen, with inclusive coordinates. */
+struct _ShadowRect
+{
+    int16_t x0, y0;
+    int16_t x1, y1;
+};
+typedef struct _ShadowRect ShadowRect;
+
+/* The most pieces of a new rectangle waiting to be placed at once. */
+#define SHADOW_PENDING_RECTS        (16)
+
+/**
+ * The shadow buffer. Each byte of [pixels] holds one palette index, or with
+ * 4 bits per pixel two of them, with the left pixel in the upper nibble.
+ * [lastIndex] caches the last color looked up, since drawing tends to use the
+ * same color many times in a row.
+ *
+ * [pending] and [line] are scratch space for [LcdShadow_markDirty()] and
+ * [LcdShadow_flush()]. They live here rather than on the 512-byte stack.
+ */
+struct _LcdShadow
+{
+    uint8_t pixels[SHADOW_BYTES];
+
+    uint16_t colors[LCD_SHADOW_COLORS];
+    uint16_t numColors;
+    uint16_t lastIndex;
+
+    ShadowRect dirty[LCD_SHADOW_DIRTY_RECTS + 1];  // One spare, see below
+    uint8_t numDirty;
+
+    ShadowRect pending[SHADOW_PENDING_RECTS];
+    uint16_t line[SHADOW_WIDTH];
+
+    uint32_t drawnBytes;    // Bytes drawn since the last flush
+    LcdShadowStats stats;
+};
+typedef struct _LcdShadow LcdShadow;
+
+/* The single instance of the shadow buffer. */
+static LcdShadow s_shadow;
+
+/**
+ * Finds the palette index of a color, adding the color to the palette if it
+ * is new. Once the palette is full, returns the index of the closest color
+ * instead, comparing red and blue at the same 6-bit precision as green, and
+ * counts the [pixels] about to be drawn with it as substituted.
+ */
+static uint8_t LcdShadow_index(uint16_t color, uint32_t pixels)
+{
+    if (s_shadow.colors[s_shadow.lastIndex] == color)
+        return s_shadow.lastIndex;
+
+    uint16_t i;
+    for (i = 0; i < s_shadow.numColors; i++)
+    {
+        if (s_shadow.colors[i] == color)
+        {
+            s_shadow.lastIndex = i;
+            return i;
+        }
+    }
+
+    if (s_shadow.numColors < LCD_SHADOW_COLORS)
+    {
+        s_shadow.colors[s_shadow.numColors] = color;
+        s_shadow.lastIndex = s_shadow.numColors++;
+        return s_shadow.lastIndex;
+    }
+
+    uint32_t bestDistance = UINT32_MAX;
+    uint16_t best = 0;
+
+    for (i = 0; i < s_shadow.numColors; i++)
+    {
+        uint16_t other = s_shadow.colors[i];
+        int32_t red = ((color >> 11) - (other >> 11)) * 2;
+        int32_t green = ((color >> 5) & 0x3F) - ((other >> 5) & 0x3F);
+        int32_t blue = ((color & 0x1F) - (other & 0x1F)) * 2;
+
+        uint32_t distance = red * red + green * green + blue * blue;
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            best = i;
+        }
+    }
+
+    s_shadow.stats.substitutedPixels += pixels;
+    return best;
+}
+
+/** Returns the palette index of one pixel. */
+static uint8_t LcdShadow_get(int16_t x, int16_t y)
+{
+    uint32_t pixel = (uint32_t) y * SHADOW_WIDTH + x;
+
+#if LCD_SHADOW_BPP == 8
+    return s_shadow.pixels[pixel];
+#else
+    uint8_t pair = s_shadow.pixels[pixel >> 1];
+    return (pixel & 1) ? (pair & 0x0F) : (pair >> 4);
+#endif
+}
+
+/** Sets the palette index of [count] pixels in a row, rightwards of (x, y). */
+static void LcdShadow_setRun(int16_t x, int16_t y, uint32_t count,
+                             uint8_t index)
+{
+    uint32_t pixel = (uint32_t) y * SHADOW_WIDTH + x;
+
+#if LCD_SHADOW_BPP == 8
+    memset(&s_shadow.pixels[pixel], index, count);
+#else
+    uint8_t* pair = &s_shadow.pixels[pixel >> 1];
+
+    // Right half of a pair, then whole pairs, then a left half
+    if ((pixel & 1) && count)
+    {
+        *pair = (*pair & 0xF0) | index;
+        pair++;
+        count--;
+    }
+
+    memset(pair, (index << 4) | index, count >> 1);
+    pair += count >> 1;
+
+    if (count & 1)
+        *pair = (*pair & 0x0F) | (index << 4);
+#endif
+}
+
+/** Returns the number of pixels in a rectangle. */
+static uint32_t ShadowRect_area(ShadowRect rect)
+{
+    return (uint32_t) (rect.x1 - rect.x0 + 1) * (rect.y1 - rect.y0 + 1);
+}
+
+/** Returns the smallest rectangle which holds both [a] and [b]. */
+static ShadowRect ShadowRect_union(ShadowRect a, ShadowRect b)
+{
+    ShadowRect rect;
+    rect.x0 = (a.x0 < b.x0) ? a.x0 : b.x0;
+    rect.y0 = (a.y0 < b.y0) ? a.y0 : b.y0;
+    rect.x1 = (a.x1 > b.x1) ? a.x1 : b.x1;
+    rect.y1 = (a.y1 > b.y1) ? a.y1 : b.y1;
+
+    return rect;
+}
+
+/** Returns how many more pixels the union of two rectangles has than both. */
+static int32_t ShadowRect_waste(ShadowRect a, ShadowRect b)
+{
+    return (int32_t) ShadowRect_area(ShadowRect_union(a, b))
+            - (int32_t) ShadowRect_area(a) - (int32_t) ShadowRect_area(b);
+}
+
+/** Returns whether two rectangles have any pixel in common. */
+static bool ShadowRect_overlaps(ShadowRect a, ShadowRect b)
+{
+    return (a.x0 <= b.x1) && (b.x0 <= a.x1) && (a.y0 <= b.y1) && (b.y0 <= a.y1);
+}
+
+/**
+ * Splits the part of [rect] outside [other], which it overlaps, into at most
+ * four rectangles: whole rows above and below [other], then the pixels to its
+ * left and right. Returns the number of rectangles written to [pieces].
+ */
+static uint8_t ShadowRect_subtract(ShadowRect rect, ShadowRect other,
+                                   ShadowRect* pieces)
+{
+    uint8_t count = 0;
+
+    if (rect.y0 < other.y0)
+    {
+        ShadowRect above = { rect.x0, rect.y0, rect.x1, other.y0 - 1 };
+        pieces[count++] = above;
+        rect.y0 = other.y0;
+    }
+
+    if (rect.y1 > other.y1)
+    {
+        ShadowRect below = { rect.x0, other.y1 + 1, rect.x1, rect.y1 };
+        pieces[count++] = below;
+        rect.y1 = other.y1;
+    }
+
+    if (rect.x0 < other.x0)
+    {
+        ShadowRect left = { rect.x0, rect.y0, other.x0 - 1, rect.y1 };
+        pieces[count++] = left;
+    }
+
+    if (rect.x1 > other.x1)
+    {
+        ShadowRect right = { other.x1 + 1, rect.y0, rect.x1, rect.y1 };
+        pieces[count++] = right;
+    }
+
+    return count;
+}
+
+/**
+ * Remembers a rectangle as changed, keeping the changed rectangles apart from
+ * each other so that no pixel is sent twice.
+ *
+ * A rectangle is merged with every changed rectangle whose union with it is no
+ * larger than the two of them apart, which covers touching rectangles and ones
+ * inside each other. Where it still crosses a changed rectangle, only the part
+ * outside that rectangle is kept, as up to four pieces which are placed in
+ * turn. A union is never split again, so that this always ends: it takes in
+ * every rectangle it overlaps instead, as does a piece once there are too many
+ * pieces waiting.
+ *
+ * If there is no room left for a rectangle, the two rectangles (counting the
+ * new one) whose union wastes the fewest pixels are merged, and the union is
+ * placed from scratch.
+ */
+static void LcdShadow_markDirty(ShadowRect rect)
+{
+    ShadowRect* pending = s_shadow.pending;
+    uint8_t numPending = 0;
+    bool splittable = true;
+
+    while (true)
+    {
+        bool placed = false;
+        uint8_t i = 0;
+
+        while (i < s_shadow.numDirty)
+        {
+            ShadowRect other = s_shadow.dirty[i];
+
+            if (!ShadowRect_overlaps(rect, other)
+                && (ShadowRect_waste(rect, other) > 0))
+            {
+                i++;
+                continue;
+            }
+
+            if ((ShadowRect_waste(rect, other) > 0) && splittable
+                && (numPending + 4 <= SHADOW_PENDING_RECTS))
+            {
+                numPending += ShadowRect_subtract(rect, other,
+                                                  &pending[numPending]);
+                placed = true;
+                break;
+            }
+
+            rect = ShadowRect_union(rect, other);
+            splittable = false;
+            s_shadow.dirty[i] = s_shadow.dirty[--s_shadow.numDirty];
+            i = 0;
+        }
+
+        if (!placed && (s_shadow.numDirty < LCD_SHADOW_DIRTY_RECTS))
+        {
+            s_shadow.dirty[s_shadow.numDirty++] = rect;
+            placed = true;
+        }
+
+        if (placed)
+        {
+            if (numPending == 0)
+                return;
+
+            rect = pending[--numPending];
+            splittable = true;
+            continue;
+        }
+
+        // dirty[numDirty] stands for the new rectangle while searching
+        s_shadow.dirty[s_shadow.numDirty] = rect;
+
+        int32_t leastWaste = INT32_MAX;
+        uint8_t first = 0, second = 0;
+        uint8_t j;
+
+        for (i = 0; i < s_shadow.numDirty; i++)
+        {
+            for (j = i + 1; j <= s_shadow.numDirty; j++)
+            {
+                int32_t waste = ShadowRect_waste(s_shadow.dirty[i],
+                                                 s_shadow.dirty[j]);
+                if (waste < leastWaste)
+                {
+                    leastWaste = waste;
+                    first = i;
+                    second = j;
+                }
+            }
+        }
+
+        // Both leave the list, and their union is placed again from scratch.
+        // If neither was the new rectangle, it takes one of their places.
+        ShadowRect merged = ShadowRect_union(s_shadow.dirty[first],
+                                             s_shadow.dirty[second]);
+        if (second == s_shadow.numDirty)
+            s_shadow.dirty[first] = s_shadow.dirty[--s_shadow.numDirty];
+        else
+        {
+            s_shadow.dirty[second] = s_shadow.dirty[--s_shadow.numDirty];
+            s_shadow.dirty[first] = rect;
+        }
+
+        rect = merged;
+        splittable = false;
+    }
+}
+
+void LcdShadow_init(uint16_t color)
+{
+    s_shadow.colors[0] = color;
+    s_shadow.numColors = 1;
+    s_shadow.lastIndex = 0;
+
+    memset(s_shadow.pixels, 0, sizeof(s_shadow.pixels));
+
+    s_shadow.numDirty = 0;
+    s_shadow.drawnBytes = 0;
+
+    memset(&s_shadow.stats, 0, sizeof(s_shadow.stats));
+    s_shadow.stats.sramBytes = sizeof(s_shadow);
+}
+
+void LcdShadow_fill(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                    uint16_t color)
+{
+    ShadowRect rect = { x0, y0, x1, y1 };
+    uint8_t index = LcdShadow_index(color, ShadowRect_area(rect));
+
+    int16_t y;
+    for (y = y0; y <= y1; y++)
+        LcdShadow_setRun(x0, y, x1 - x0 + 1, index);
+
+    s_shadow.drawnBytes += ShadowRect_area(rect) * 2;
+    LcdShadow_markDirty(rect);
+}
+
+void LcdShadow_writeLine(int16_t x, int16_t y, const uint16_t* pixels,
+                         uint32_t count)
+{
+    if (count == 0)
+        return;
+
+    uint32_t i;
+    for (i = 0; i < count; i++)
+        LcdShadow_setRun(x + i, y, 1, LcdShadow_index(pixels[i], 1));
+
+    ShadowRect rect = { x, y, x + count - 1, y };
+    s_shadow.drawnBytes += count * 2;
+    LcdShadow_markDirty(rect);
+}
+
+void LcdShadow_invalidate(void)
+{
+    s_shadow.numDirty = 0;
+
+    ShadowRect screen = { 0, 0, SHADOW_WIDTH - 1, SHADOW_HEIGHT - 1 };
+    LcdShadow_markDirty(screen);
+}
+
+/**
+ * Sends each changed rectangle to the LCD a line at a time, translating the
+ * palette indices back into 5-6-5 colors as it goes.
+ */
+void LcdShadow_flush(void)
+{
+    if (s_shadow.numDirty == 0)
+        return;
+
+    uint16_t* line = s_shadow.line;
+    uint32_t sentBytes = 0;
+
+    uint8_t i;
+    for (i = 0; i < s_shadow.numDirty; i++)
+    {
+        ShadowRect rect = s_shadow.dirty[i];
+
+        Crystalfontz128x128_SetDrawFrame(rect.x0, rect.y0, rect.x1, rect.y1);
+        HAL_LCD_writeCommand(CM_RAMWR);
+
+        int16_t x, y;
+        for (y = rect.y0; y <= rect.y1; y++)
+        {
+            for (x = rect.x0; x <= rect.x1; x++)
+                line[x - rect.x0] = s_shadow.colors[LcdShadow_get(x, y)];
+
+            HAL_LCD_writeBuffer16(line, rect.x1 - rect.x0 + 1);
+        }
+
+        sentBytes += ShadowRect_area(rect) * 2;
+    }
+
+    s_shadow.stats.frames++;
+    s_shadow.stats.drawnBytes = s_shadow.drawnBytes;
+    s_shadow.stats.sentBytes = sentBytes;
+    s_shadow.stats.totalDrawn += s_shadow.drawnBytes;
+    s_shadow.stats.totalSent += sentBytes;
+
+    s_shadow.numDirty = 0;
+    s_shadow.drawnBytes = 0;
+}
+
+LcdShadowStats LcdShadow_stats(void)
+{
+    LcdShadowStats stats = s_shadow.stats;
+    stats.colors = s_shadow.numColors;
+
+    return stats;
+}
+
+#endif /* LCD_SHADOW_BUFFER */
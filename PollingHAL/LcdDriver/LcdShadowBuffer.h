@@ -0,0 +1,102 @@
+/*
+ * LcdShadowBuffer.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  An optional copy of the LCD's contents in SRAM. With LCD_SHADOW_BUFFER
+ *  defined, the Crystalfontz128x128 drawing primitives draw into this buffer
+ *  instead of sending pixels to the LCD, and only remember which rectangles
+ *  they changed. [Graphics_flushBuffer()] then sends each changed rectangle
+ *  once, so a region which is cleared and then drawn over is only sent with
+ *  its final contents.
+ *
+ *  A full 5-6-5 copy of the screen would take 32 KB, half of the SRAM, so the
+ *  buffer keeps a palette index per pixel instead: LCD_SHADOW_BPP bits, 8 by
+ *  default (16 KB, up to 256 colors) or 4 (8 KB, up to 16 colors). Colors are
+ *  added to the palette as they are first drawn, and stay in it until the next
+ *  [LcdShadow_init()], even once nothing on screen uses them. Once it is full,
+ *  any other color is drawn as the closest color already in the palette, so
+ *  the screen no longer shows exactly what was drawn. [substitutedPixels] in
+ *  [LcdShadow_stats()] counts the pixels this happened to; if it is not zero,
+ *  use fewer colors or a larger LCD_SHADOW_BPP.
+ *
+ *  The line buffer of a flush and the rectangles waiting to be placed take
+ *  another 384 bytes, which are kept in the buffer's SRAM (and counted in
+ *  [sramBytes]) rather than on the 512-byte stack. Drawing and flushing
+ *  themselves only use a few dozen bytes of stack.
+ *
+ *  The buffer is flushed from the main application, never from an ISR, and
+ *  the screen only changes when it is flushed, so remember to call
+ *  [Graphics_flushBuffer()] once a frame is drawn.
+ */
+
+#ifndef LCDSHADOWBUFFER_H_
+#define LCDSHADOWBUFFER_H_
+
+#include <stdint.h>
+
+#ifdef LCD_SHADOW_BUFFER
+
+#ifndef LCD_SHADOW_BPP
+#define LCD_SHADOW_BPP              (8)
+#endif
+
+#if (LCD_SHADOW_BPP != 4) && (LCD_SHADOW_BPP != 8)
+#error "LCD_SHADOW_BPP must be 4 or 8"
+#endif
+
+/* The number of colors the palette holds. */
+#define LCD_SHADOW_COLORS           (1 << LCD_SHADOW_BPP)
+
+/* The number of separate rectangles which are remembered as changed. Beyond
+ * this, the two whose union wastes the fewest pixels are merged. */
+#ifndef LCD_SHADOW_DIRTY_RECTS
+#define LCD_SHADOW_DIRTY_RECTS      (16)
+#endif
+
+/**
+ * What the shadow buffer costs and saves. Only pixel data is counted in
+ * [drawnBytes] and [sentBytes], not the commands which frame it.
+ */
+struct _LcdShadowStats
+{
+    uint32_t sramBytes;     // SRAM taken by the buffer, palette and rectangles
+    uint32_t colors;        // Colors in the palette so far
+    uint32_t frames;        // Number of flushes which sent anything
+
+    uint32_t drawnBytes;    // Bytes drawn in the last frame, which would have
+                            // been sent to the LCD without the buffer
+    uint32_t sentBytes;     // Bytes actually sent by the last flush
+
+    uint64_t totalDrawn;    // The same two, summed over every frame
+    uint64_t totalSent;
+
+    uint32_t substitutedPixels; // Pixels drawn in the closest palette color,
+                                // since their own did not fit in the palette
+};
+typedef struct _LcdShadowStats LcdShadowStats;
+
+/* Fills the buffer with [color], which the LCD must already show, and forgets
+ * every color and rectangle. */
+void LcdShadow_init(uint16_t color);
+
+/* Draw into the buffer. Coordinates are inclusive, and must be within the
+ * screen. [writeLine()] draws [count] pixels to the right of (x, y). */
+void LcdShadow_fill(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                    uint16_t color);
+void LcdShadow_writeLine(int16_t x, int16_t y, const uint16_t* pixels,
+                         uint32_t count);
+
+/* Marks the whole screen as changed, for when the LCD no longer shows what the
+ * buffer holds (after its orientation changes, for example). */
+void LcdShadow_invalidate(void);
+
+/* Sends every changed rectangle to the LCD. */
+void LcdShadow_flush(void);
+
+LcdShadowStats LcdShadow_stats(void);
+
+#endif /* LCD_SHADOW_BUFFER */
+
+#endif /* LCDSHADOWBUFFER_H_ */
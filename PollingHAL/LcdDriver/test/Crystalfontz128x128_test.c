@@ -0,0 +1,430 @@
+/*
+ * Crystalfontz128x128_test.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  Host-side checks for the Crystalfontz128x128 drawing primitives. The LCD
+ *  HAL is replaced by an emulated ST7735, which follows CASET, RASET and RAMWR
+ *  into its own memory the way the controller does, and counts every byte sent
+ *  over the SPI. Each workload is drawn through the driver's function table
+ *  and compared pixel by pixel with a reference image drawn directly, then the
+ *  number of bytes it took is checked against the figures below. The stubs for
+ *  grlib and driverlib in this directory stand in for the real ones. This file
+ *  has its own main() and is excluded from the CCS build; from the repository
+ *  root, build and run it on the host with:
+ *
+ *      gcc -std=c99 -Wall -IPollingHAL/LcdDriver/test -I. \
+ *          PollingHAL/LcdDriver/test/Crystalfontz128x128_test.c -o lcd_test
+ *      ./lcd_test
+ *
+ *  Add -DLCD_PIXEL_RUNS to test PixelDraw with pixel runs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Included rather than linked, so that the driver is built for the test
+#include "../Crystalfontz128x128_ST7735.c"
+
+/* The controller's memory is larger than the panel, which starts at an
+ * offset that depends on the orientation (2, 3 when it is up). */
+#define LCD_MEMORY_SIZE         (162)
+#define PANEL_X                 (2)
+#define PANEL_Y                 (3)
+
+/* The emulated ST7735. */
+struct _TestSt7735
+{
+    uint16_t memory[LCD_MEMORY_SIZE][LCD_MEMORY_SIZE];
+
+    uint8_t command;            // The last command received
+    uint8_t args[4];            // Data bytes received after CASET or RASET
+    uint8_t numArgs;
+    int16_t highByte;           // First byte of a pixel, or -1
+
+    uint16_t x0, x1, y0, y1;    // The window
+    uint16_t x, y;              // Where the next pixel goes
+
+    uint32_t bytes;             // Bytes sent over the SPI
+    uint32_t commands;
+};
+typedef struct _TestSt7735 TestSt7735;
+
+static TestSt7735 s_st7735;
+static uint16_t s_reference[LCD_VERTICAL_MAX][LCD_HORIZONTAL_MAX];
+static int s_failures = 0;
+
+void HAL_LCD_writeCommand(uint8_t command)
+{
+    s_st7735.bytes++;
+    s_st7735.commands++;
+
+    s_st7735.command = command;
+    s_st7735.numArgs = 0;
+    s_st7735.highByte = -1;
+
+    if (command == CM_RAMWR)
+    {
+        s_st7735.x = s_st7735.x0;
+        s_st7735.y = s_st7735.y0;
+    }
+}
+
+void HAL_LCD_writeData(uint8_t data)
+{
+    s_st7735.bytes++;
+
+    if ((s_st7735.command == CM_CASET) || (s_st7735.command == CM_RASET))
+    {
+        if (s_st7735.numArgs == 4)
+            return;
+
+        s_st7735.args[s_st7735.numArgs++] = data;
+        if (s_st7735.numArgs < 4)
+            return;
+
+        uint16_t start = (s_st7735.args[0] << 8) | s_st7735.args[1];
+        uint16_t end = (s_st7735.args[2] << 8) | s_st7735.args[3];
+
+        if (s_st7735.command == CM_CASET)
+        {
+            s_st7735.x0 = start;
+            s_st7735.x1 = end;
+        }
+        else
+        {
+            s_st7735.y0 = start;
+            s_st7735.y1 = end;
+        }
+    }
+    else if (s_st7735.command == CM_RAMWR)
+    {
+        if (s_st7735.highByte < 0)
+        {
+            s_st7735.highByte = data;
+            return;
+        }
+
+        s_st7735.memory[s_st7735.y][s_st7735.x] =
+            (s_st7735.highByte << 8) | data;
+        s_st7735.highByte = -1;
+
+        // Left to right, then top to bottom, wrapping within the window
+        if (++s_st7735.x > s_st7735.x1)
+        {
+            s_st7735.x = s_st7735.x0;
+            if (++s_st7735.y > s_st7735.y1)
+                s_st7735.y = s_st7735.y0;
+        }
+    }
+}
+
+void HAL_LCD_writeRepeat16(uint16_t color, uint32_t count)
+{
+    while (count--)
+    {
+        HAL_LCD_writeData(color >> 8);
+        HAL_LCD_writeData((uint8_t) color);
+    }
+}
+
+void HAL_LCD_writeBuffer16(const uint16_t* pixels, uint32_t count)
+{
+    while (count--)
+    {
+        HAL_LCD_writeData(*pixels >> 8);
+        HAL_LCD_writeData((uint8_t) *pixels);
+        pixels++;
+    }
+}
+
+void HAL_LCD_writeDataBuffer(const uint8_t* data, uint32_t length)
+{
+    while (length--)
+        HAL_LCD_writeData(*data++);
+}
+
+uint32_t HAL_LCD_commandCount(void)
+{
+    return s_st7735.commands;
+}
+
+void HAL_LCD_PortInit(void) {}
+void HAL_LCD_SpiInit(void) {}
+void HAL_LCD_delay(uint32_t ms) { (void) ms; }
+void HAL_LCD_waitIdle(void) {}
+
+void GPIO_setOutputLowOnPin(uint_fast8_t selectedPort,
+                            uint_fast16_t selectedPins) {}
+void GPIO_setOutputHighOnPin(uint_fast8_t selectedPort,
+                             uint_fast16_t selectedPins) {}
+
+/******************************************************************************/
+/* WORKLOADS                                                                  */
+/******************************************************************************/
+
+static void PixelDraw(int16_t x, int16_t y, uint16_t color)
+{
+    g_sCrystalfontz128x128_funcs.pfnPixelDraw(&g_sCrystalfontz128x128, x, y,
+                                              color);
+    s_reference[y][x] = color;
+}
+
+static void LineDrawH(int16_t x1, int16_t x2, int16_t y, uint16_t color)
+{
+    int16_t x;
+
+    g_sCrystalfontz128x128_funcs.pfnLineDrawH(&g_sCrystalfontz128x128, x1, x2,
+                                              y, color);
+    for (x = x1; x <= x2; x++)
+        s_reference[y][x] = color;
+}
+
+/**
+ * Draws a line pixel by pixel the way grlib does: Bresenham along the major
+ * axis, always in increasing order along it.
+ */
+static void Line(int16_t x1, int16_t y1, int16_t x2, int16_t y2,
+                 uint16_t color)
+{
+    bool steep = abs(y2 - y1) > abs(x2 - x1);
+    int16_t swap, x, y, dx, dy, error, yStep;
+
+    if (steep)
+    {
+        swap = x1; x1 = y1; y1 = swap;
+        swap = x2; x2 = y2; y2 = swap;
+    }
+
+    if (x1 > x2)
+    {
+        swap = x1; x1 = x2; x2 = swap;
+        swap = y1; y1 = y2; y2 = swap;
+    }
+
+    dx = x2 - x1;
+    dy = abs(y2 - y1);
+    error = dx / 2;
+    yStep = (y1 < y2) ? 1 : -1;
+    y = y1;
+
+    for (x = x1; x <= x2; x++)
+    {
+        if (steep)
+            PixelDraw(y, x, color);
+        else
+            PixelDraw(x, y, color);
+
+        error -= dy;
+        if (error < 0)
+        {
+            y += yStep;
+            error += dx;
+        }
+    }
+}
+
+/** Draws a circle eight symmetric points at a time, as grlib does. */
+static void Circle(int16_t x0, int16_t y0, int16_t radius, uint16_t color)
+{
+    int16_t a = 0, b = radius, d = 3 - 2 * radius;
+
+    while (a <= b)
+    {
+        PixelDraw(x0 + a, y0 + b, color);
+        PixelDraw(x0 - a, y0 + b, color);
+        PixelDraw(x0 + a, y0 - b, color);
+        PixelDraw(x0 - a, y0 - b, color);
+        PixelDraw(x0 + b, y0 + a, color);
+        PixelDraw(x0 - b, y0 + a, color);
+        PixelDraw(x0 + b, y0 - a, color);
+        PixelDraw(x0 - b, y0 - a, color);
+
+        if (d < 0)
+            d += 4 * a + 6;
+        else
+        {
+            d += 4 * (a - b) + 10;
+            b--;
+        }
+
+        a++;
+    }
+}
+
+/* A 5x7 font with the letters the workloads need. Each glyph is its letter
+ * followed by seven rows, with '1' for a pixel which is drawn. */
+static const char* const s_font[] =
+{
+    "H", "10001", "10001", "10001", "11111", "10001", "10001", "10001",
+    "E", "11111", "10000", "10000", "11110", "10000", "10000", "11111",
+    "L", "10000", "10000", "10000", "10000", "10000", "10000", "11111",
+    "O", "01110", "10001", "10001", "10001", "10001", "10001", "01110",
+    "W", "10001", "10001", "10001", "10101", "10101", "10101", "01010",
+    "R", "11110", "10001", "10001", "11110", "10100", "10010", "10001",
+    "D", "11110", "10001", "10001", "10001", "10001", "10001", "11110",
+    NULL
+};
+
+/**
+ * Draws transparent text the way grlib does: each run of set pixels in a
+ * glyph row is drawn with LineDrawH, and single pixels with PixelDraw. With
+ * [perPixel], every pixel is drawn with PixelDraw.
+ */
+static void Text(const char* text, int16_t x, int16_t y, uint16_t color,
+                 bool perPixel)
+{
+    int glyph, row, i, j, k;
+
+    for (; *text; text++, x += 6)
+    {
+        if (*text == ' ')
+            continue;
+
+        for (glyph = 0; s_font[glyph][0] != *text; glyph += 8);
+
+        for (row = 0; row < 7; row++)
+        {
+            const char* bits = s_font[glyph + 1 + row];
+
+            for (i = 0; i < 5; i = j)
+            {
+                for (j = i; (j < 5) && (bits[j] == '1'); j++);
+
+                if (j == i)
+                {
+                    j++;
+                    continue;
+                }
+
+                if (perPixel || (j - i == 1))
+                {
+                    for (k = i; k < j; k++)
+                        PixelDraw(x + k, y + row, color);
+                }
+                else
+                    LineDrawH(x + i, x + j - 1, y + row, color);
+            }
+        }
+    }
+}
+
+static void DrawFan(void)
+{
+    int16_t i;
+    for (i = 0; i < 128; i += 16)
+    {
+        Line(64, 64, i, 0, 0x1111);
+        Line(64, 64, 127, i, 0x2222);
+        Line(64, 64, 127 - i, 127, 0x3333);
+        Line(64, 64, 0, 127 - i, 0x4444);
+    }
+}
+
+static void DrawSteep(void)
+{
+    int16_t i;
+    for (i = 0; i < 8; i++)
+        Line(10 + i * 12, 0, 20 + i * 12, 127, 0x5555);
+}
+
+static void DrawShallow(void)
+{
+    int16_t i;
+    for (i = 0; i < 8; i++)
+        Line(0, 10 + i * 12, 127, 20 + i * 12, 0x6666);
+}
+
+static void DrawCircles(void)
+{
+    Circle(64, 64, 40, 0x7777);
+    Circle(64, 64, 20, 0x8888);
+}
+
+static void DrawText(void)
+{
+    Text("HELLO WORLD", 2, 20, 0x9999, false);
+    Text("HOLD HER", 2, 40, 0x9999, false);
+}
+
+static void DrawTextPerPixel(void)
+{
+    Text("HELLO WORLD", 2, 60, 0xAAAA, true);
+    Text("HOLD HER", 2, 80, 0xAAAA, true);
+}
+
+/**
+ * Draws a workload and flushes, checks the emulated LCD against the reference
+ * image and the bytes sent against [expected], and returns the bytes sent.
+ */
+static uint32_t Run(const char* name, void (*draw)(void), uint32_t expected)
+{
+    uint32_t start = s_st7735.bytes;
+    int16_t x, y;
+
+    draw();
+    g_sCrystalfontz128x128_funcs.pfnFlush(&g_sCrystalfontz128x128);
+
+    uint32_t bytes = s_st7735.bytes - start;
+
+    for (y = 0; y < LCD_VERTICAL_MAX; y++)
+    {
+        for (x = 0; x < LCD_HORIZONTAL_MAX; x++)
+        {
+            if (s_st7735.memory[y + PANEL_Y][x + PANEL_X] != s_reference[y][x])
+            {
+                printf("FAIL %s: differs at (%d, %d)\n", name, x, y);
+                s_failures++;
+                return bytes;
+            }
+        }
+    }
+
+    printf("%-28s %6u bytes\n", name, (unsigned) bytes);
+
+    if (bytes != expected)
+    {
+        printf("FAIL %s: expected %u bytes\n", name, (unsigned) expected);
+        s_failures++;
+    }
+
+    return bytes;
+}
+
+/* SPI bytes each workload takes, without and with LCD_PIXEL_RUNS. The
+ * workloads run in this order on one screen, so each starts with the window
+ * the last one left behind. */
+#ifdef LCD_PIXEL_RUNS
+#define EXPECTED(withoutRuns, withRuns)     (withRuns)
+#else
+#define EXPECTED(withoutRuns, withRuns)     (withoutRuns)
+#endif
+
+int main(void)
+{
+    uint32_t total = 0;
+
+    // Crystalfontz128x128_Init() is not called: it only sets the controller
+    // up, and leaves the window cache as invalid as it starts out here.
+    s_st7735.highByte = -1;
+
+    total += Run("32 lines fanned out", DrawFan, EXPECTED(18670, 15680));
+    total += Run("8 steep lines", DrawSteep, EXPECTED(8632, 3016));
+    total += Run("8 shallow lines", DrawShallow, EXPECTED(3016, 3016));
+    total += Run("circles, r = 40 and 20", DrawCircles, EXPECTED(3651, 3651));
+    total += Run("text, runs via LineDrawH", DrawText, EXPECTED(1998, 1914));
+    total += Run("text, pixel by pixel", DrawTextPerPixel,
+                 EXPECTED(1998, 1914));
+
+    printf("%-28s %6u bytes\n", "total", (unsigned) total);
+
+    if (s_failures)
+    {
+        printf("%d check(s) failed\n", s_failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All Crystalfontz128x128 checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,295 @@
+/*
+ * LcdShadowBuffer_test.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  Host-side checks for the LCD shadow buffer. The LCD is replaced by an
+ *  array which the flush writes into through the draw window, the way the
+ *  ST7735 fills its own memory, and every frame is compared pixel by pixel
+ *  with a reference image drawn directly. The stubs for grlib and driverlib
+ *  in this directory stand in for the real ones. This file has its own
+ *  main() and is excluded from the CCS build; from the repository root, build
+ *  and run it on the host with:
+ *
+ *      gcc -std=c99 -Wall -IPollingHAL/LcdDriver/test -I. \
+ *          PollingHAL/LcdDriver/test/LcdShadowBuffer_test.c -o shadow_test
+ *      ./shadow_test
+ *
+ *  Add -DLCD_SHADOW_BPP=4 to test the 4 bits per pixel buffer.
+ */
+
+#define LCD_SHADOW_BUFFER
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Included rather than linked, so that the buffer is built for the test
+#include "../LcdShadowBuffer.c"
+
+#define SCREEN_SIZE             (128)
+#define BACKGROUND              (0xFFFF)
+
+/* The emulated LCD, and the frame it last received each pixel in. */
+struct _TestLcd
+{
+    uint16_t pixels[SCREEN_SIZE][SCREEN_SIZE];
+    uint32_t sentInFrame[SCREEN_SIZE][SCREEN_SIZE];
+
+    int16_t x0, y0, x1, y1;     // The draw window
+    int16_t x, y;               // Where the next pixel goes
+    uint32_t frame;
+
+    uint32_t duplicates;        // Pixels sent twice in one frame
+};
+typedef struct _TestLcd TestLcd;
+
+static TestLcd s_lcd;
+static uint16_t s_reference[SCREEN_SIZE][SCREEN_SIZE];
+static int s_failures = 0;
+
+void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1,
+                                      uint16_t y1)
+{
+    s_lcd.x0 = x0;
+    s_lcd.y0 = y0;
+    s_lcd.x1 = x1;
+    s_lcd.y1 = y1;
+}
+
+void HAL_LCD_writeCommand(uint8_t command)
+{
+    if (command == CM_RAMWR)
+    {
+        s_lcd.x = s_lcd.x0;
+        s_lcd.y = s_lcd.y0;
+    }
+}
+
+void HAL_LCD_writeBuffer16(const uint16_t* pixels, uint32_t count)
+{
+    while (count--)
+    {
+        if (s_lcd.sentInFrame[s_lcd.y][s_lcd.x] == s_lcd.frame)
+            s_lcd.duplicates++;
+
+        s_lcd.sentInFrame[s_lcd.y][s_lcd.x] = s_lcd.frame;
+        s_lcd.pixels[s_lcd.y][s_lcd.x] = *pixels++;
+
+        if (++s_lcd.x > s_lcd.x1)
+        {
+            s_lcd.x = s_lcd.x0;
+            s_lcd.y++;
+        }
+    }
+}
+
+static void Check(const char* what, uint64_t actual, uint64_t expected)
+{
+    if (actual != expected)
+    {
+        printf("FAIL %s: got %llu, expected %llu\n", what,
+               (unsigned long long) actual, (unsigned long long) expected);
+        s_failures++;
+    }
+}
+
+/** Starts over with a blank screen, buffer and reference. */
+static void Reset(void)
+{
+    int x, y;
+    for (y = 0; y < SCREEN_SIZE; y++)
+    {
+        for (x = 0; x < SCREEN_SIZE; x++)
+        {
+            s_lcd.pixels[y][x] = BACKGROUND;
+            s_lcd.sentInFrame[y][x] = 0;
+            s_reference[y][x] = BACKGROUND;
+        }
+    }
+
+    s_lcd.frame = 0;
+    s_lcd.duplicates = 0;
+    LcdShadow_init(BACKGROUND);
+}
+
+static void Fill(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                 uint16_t color)
+{
+    int x, y;
+
+    LcdShadow_fill(x0, y0, x1, y1, color);
+
+    for (y = y0; y <= y1; y++)
+        for (x = x0; x <= x1; x++)
+            s_reference[y][x] = color;
+}
+
+static void WriteLine(int16_t x, int16_t y, const uint16_t* pixels,
+                      uint32_t count)
+{
+    uint32_t i;
+
+    LcdShadow_writeLine(x, y, pixels, count);
+
+    for (i = 0; i < count; i++)
+        s_reference[y][x + i] = pixels[i];
+}
+
+/** Flushes, then checks that the LCD shows the reference image. */
+static void FlushAndCompare(const char* what)
+{
+    int x, y;
+
+    s_lcd.frame++;
+    LcdShadow_flush();
+
+    for (y = 0; y < SCREEN_SIZE; y++)
+    {
+        for (x = 0; x < SCREEN_SIZE; x++)
+        {
+            if (s_lcd.pixels[y][x] != s_reference[y][x])
+            {
+                printf("FAIL %s: frame %u differs at (%d, %d)\n", what,
+                       (unsigned) s_lcd.frame, x, y);
+                s_failures++;
+                return;
+            }
+        }
+    }
+}
+
+/** Random fills and lines, which overlap and cross each other. */
+static void TestRandomFrames(void)
+{
+    uint32_t seed = 1;
+    uint32_t frame;
+    int i;
+
+    Reset();
+
+    for (frame = 0; frame < 200; frame++)
+    {
+        for (i = 0; i < 20; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            int16_t x0 = (seed >> 8) % SCREEN_SIZE;
+            int16_t y0 = (seed >> 16) % SCREEN_SIZE;
+
+            seed = seed * 1103515245 + 12345;
+            int16_t x1 = x0 + (seed >> 8) % 20;
+            int16_t y1 = y0 + (seed >> 16) % 20;
+
+            if (x1 >= SCREEN_SIZE)
+                x1 = SCREEN_SIZE - 1;
+            if (y1 >= SCREEN_SIZE)
+                y1 = SCREEN_SIZE - 1;
+
+            // Stays within the palette, so nothing is substituted
+            Fill(x0, y0, x1, y1, (seed >> 3) % (LCD_SHADOW_COLORS - 1));
+        }
+
+        uint16_t line[5] = { 1, 2, 3, 4, 5 };
+        WriteLine(3, 7, line, 5);
+
+        FlushAndCompare("random frames");
+    }
+
+    Check("random frames duplicates", s_lcd.duplicates, 0);
+    Check("random frames substituted", LcdShadow_stats().substitutedPixels, 0);
+}
+
+/** A plus sign: the overlap of the two bars is sent once. */
+static void TestCrossingRects(void)
+{
+    Reset();
+
+    Fill(10, 50, 110, 59, 0x0000);
+    Fill(55, 10, 64, 110, 0x0000);
+    FlushAndCompare("crossing rectangles");
+
+    LcdShadowStats stats = LcdShadow_stats();
+    Check("crossing duplicates", s_lcd.duplicates, 0);
+    Check("crossing drawn", stats.drawnBytes, (101 * 10 + 10 * 101) * 2);
+    Check("crossing sent", stats.sentBytes, (101 * 10 + 10 * 101 - 100) * 2);
+}
+
+/**
+ * Clearing a 120x32 text panel and drawing three lines of 20 glyphs over it,
+ * each glyph drawn as 8 rows of 6 pixels.
+ */
+static void TestTextPanel(void)
+{
+    uint16_t row[6];
+    int i, line, glyph, y;
+
+    for (i = 0; i < 6; i++)
+        row[i] = (i & 1) ? 0xF800 : 0x0000;
+
+    Reset();
+
+    for (i = 0; i < 10; i++)
+    {
+        Fill(4, 40, 123, 71, 0x0000);
+
+        for (line = 0; line < 3; line++)
+            for (glyph = 0; glyph < 20; glyph++)
+                for (y = 0; y < 8; y++)
+                    WriteLine(4 + glyph * 6, 42 + line * 10 + y, row, 6);
+
+        FlushAndCompare("text panel");
+    }
+
+    LcdShadowStats stats = LcdShadow_stats();
+    Check("text panel duplicates", s_lcd.duplicates, 0);
+    Check("text panel drawn", stats.drawnBytes, 13440);
+    Check("text panel sent", stats.sentBytes, 7680);
+
+    printf("Text panel: %u bytes drawn, %u sent, %u bytes of SRAM\n",
+           (unsigned) stats.drawnBytes, (unsigned) stats.sentBytes,
+           (unsigned) stats.sramBytes);
+}
+
+/** Colors beyond the palette are drawn as the closest one, and counted. */
+static void TestPaletteFull(void)
+{
+    uint16_t color;
+
+    Reset();
+
+    // The background is already in the palette. The colors filling it are
+    // 0x0000 upwards, so they only have the lowest few shades of green.
+    for (color = 0; color < LCD_SHADOW_COLORS - 1; color++)
+        Fill(color % SCREEN_SIZE, color / SCREEN_SIZE, color % SCREEN_SIZE,
+             color / SCREEN_SIZE, color);
+
+    FlushAndCompare("full palette");
+    Check("full palette colors", LcdShadow_stats().colors, LCD_SHADOW_COLORS);
+    Check("full palette substituted", LcdShadow_stats().substitutedPixels, 0);
+
+    // Pure green is nowhere in the palette, so it comes out as the greenest
+    // color in it: 0x00E0 with 256 colors, and black with 16
+    LcdShadow_fill(0, 10, 9, 19, 0x07E0);
+    LcdShadow_flush();
+
+    Check("substituted color", s_lcd.pixels[10][0],
+          (LCD_SHADOW_COLORS == 256) ? 0x00E0 : 0x0000);
+    Check("substituted pixels", LcdShadow_stats().substitutedPixels, 100);
+}
+
+int main(void)
+{
+    TestRandomFrames();
+    TestCrossingRects();
+    TestTextPanel();
+    TestPaletteFull();
+
+    if (s_failures)
+    {
+        printf("%d check(s) failed\n", s_failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All LcdShadowBuffer checks passed\n");
+    return EXIT_SUCCESS;
+}
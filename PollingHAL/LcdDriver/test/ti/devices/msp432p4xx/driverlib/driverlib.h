@@ -0,0 +1,32 @@
+/*
+ * driverlib.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  A host-side stand-in for the few MSP432 driverlib names the LCD driver
+ *  needs in order to compile on a host. The host tests in this directory
+ *  provide the functions themselves. The board build uses the real driverlib.
+ */
+
+#ifndef DRIVERLIB_H_
+#define DRIVERLIB_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GPIO_PORT_P1        1
+#define GPIO_PORT_P3        3
+#define GPIO_PORT_P5        5
+
+#define GPIO_PIN0           0x0001
+#define GPIO_PIN5           0x0020
+#define GPIO_PIN6           0x0040
+#define GPIO_PIN7           0x0080
+
+void GPIO_setOutputLowOnPin(uint_fast8_t selectedPort,
+                            uint_fast16_t selectedPins);
+void GPIO_setOutputHighOnPin(uint_fast8_t selectedPort,
+                             uint_fast16_t selectedPins);
+
+#endif /* DRIVERLIB_H_ */
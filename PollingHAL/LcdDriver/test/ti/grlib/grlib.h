@@ -0,0 +1,53 @@
+/*
+ * grlib.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  A host-side stand-in for the parts of TI's Graphics Library the LCD driver
+ *  uses: the display, its function table and rectangles. Only for the host
+ *  tests in this directory - the board build uses the real grlib.
+ */
+
+#ifndef GRLIB_H_
+#define GRLIB_H_
+
+#include <stdint.h>
+
+typedef struct Graphics_Display
+{
+    int32_t size;
+    void* displayData;
+    uint16_t width;
+    uint16_t heigth;
+} Graphics_Display;
+
+typedef struct Graphics_Rectangle
+{
+    int16_t sXMin;
+    int16_t sYMin;
+    int16_t sXMax;
+    int16_t sYMax;
+} Graphics_Rectangle;
+
+typedef struct Graphics_Display_Functions
+{
+    void (*pfnPixelDraw)(const Graphics_Display* display, int16_t x, int16_t y,
+                         uint16_t value);
+    void (*pfnPixelDrawMultiple)(const Graphics_Display* display, int16_t x,
+                                 int16_t y, int16_t x0, int16_t count,
+                                 int16_t bPP, const uint8_t* data,
+                                 const uint32_t* palette);
+    void (*pfnLineDrawH)(const Graphics_Display* display, int16_t x1,
+                         int16_t x2, int16_t y, uint16_t value);
+    void (*pfnLineDrawV)(const Graphics_Display* display, int16_t x,
+                         int16_t y1, int16_t y2, uint16_t value);
+    void (*pfnRectFill)(const Graphics_Display* display,
+                        const Graphics_Rectangle* rect, uint16_t value);
+    uint32_t (*pfnColorTranslate)(const Graphics_Display* display,
+                                  uint32_t value);
+    void (*pfnFlush)(const Graphics_Display* display);
+    void (*pfnClearDisplay)(const Graphics_Display* display, uint16_t value);
+} Graphics_Display_Functions;
+
+#endif /* GRLIB_H_ */
@@ -7,13 +7,101 @@
 
 #include <PollingHAL/SWTimer.h>
 
-/** The reference counter which tracks how many rollovers have occurred. Used in timing SWTimers. */
-static volatile uint64_t hwTimerRollovers = 1;
+/**
+ * The reference counter which tracks how many rollovers have occurred. Used in timing SWTimers. It is
+ * 32 bits wide so that it can be read in a single load - at 48 MHz, it takes over 12000 years to wrap.
+ */
+static volatile uint32_t hwTimerRollovers = 1;
+
+// TIMER32_0 counts down from LOADVALUE to 0 inclusive, so one period is one cycle longer than that.
+#define TIMER_PERIOD            ((uint64_t) LOADVALUE + 1)
+
+/** The RTC time when Clock_suspend() was last called, in 1/32768ths of a second since 2000. */
+static uint64_t rtcAtSuspend = 0;
+
+// The RTC counts BCLK (REFO) cycles, and there are this many of them in a second.
+#define RTC_TICKS_PER_SECOND    32768
+#define SECONDS_PER_DAY         86400
+
+// The number of days from 1 March of the year 0 until 1 January 2000, where the RTC starts.
+#define DAYS_UNTIL_2000         730425
+
+/**
+ * The DCO frequencies the system clock can run at, slowest first, along with what each of them
+ * needs from the rest of the chip. Every entry runs at twice the frequency of the one before it,
+ * which is what lets Clock_now() turn TIMER32_0 cycles into ticks with a shift. The core voltage
+ * levels and wait states are the ones system_msp432p401r.c uses for the same frequencies.
+ */
+struct _DcoFrequency
+{
+    uint32_t frequency;             // MCLK and HSMCLK, in Hz
+    uint32_t peripheralFrequency;   // SMCLK, in Hz
+    uint32_t dcoRange;              // The CS_DCO_FREQUENCY_* to center the DCO on
+    uint32_t coreVoltage;           // PCM_VCORE0 or PCM_VCORE1
+    uint32_t waitStates;            // Flash wait states for both flash banks
+    uint32_t smclkDivider;          // Keeps SMCLK at or below its 24 MHz limit
+};
+typedef struct _DcoFrequency DcoFrequency;
+
+static const DcoFrequency s_dcoFrequencies[] =
+{
+    {  1500000,  1500000, CS_DCO_FREQUENCY_1_5, PCM_VCORE0, 0, CS_CLOCK_DIVIDER_1 },
+    {  3000000,  3000000, CS_DCO_FREQUENCY_3,   PCM_VCORE0, 0, CS_CLOCK_DIVIDER_1 },
+    {  6000000,  6000000, CS_DCO_FREQUENCY_6,   PCM_VCORE0, 0, CS_CLOCK_DIVIDER_1 },
+    { 12000000, 12000000, CS_DCO_FREQUENCY_12,  PCM_VCORE0, 0, CS_CLOCK_DIVIDER_1 },
+    { 24000000, 24000000, CS_DCO_FREQUENCY_24,  PCM_VCORE0, 1, CS_CLOCK_DIVIDER_1 },
+    { 48000000, 24000000, CS_DCO_FREQUENCY_48,  PCM_VCORE1, 1, CS_CLOCK_DIVIDER_2 }
+};
+
+#define NUM_DCO_FREQUENCIES     (sizeof(s_dcoFrequencies) / sizeof(s_dcoFrequencies[0]))
+
+// The entry of s_dcoFrequencies which matches SYSTEM_CLOCK.
+#if   SYSTEM_CLOCK == 1500000
+#define BOOT_FREQUENCY          0
+#elif SYSTEM_CLOCK == 3000000
+#define BOOT_FREQUENCY          1
+#elif SYSTEM_CLOCK == 6000000
+#define BOOT_FREQUENCY          2
+#elif SYSTEM_CLOCK == 12000000
+#define BOOT_FREQUENCY          3
+#elif SYSTEM_CLOCK == 24000000
+#define BOOT_FREQUENCY          4
+#elif SYSTEM_CLOCK == 48000000
+#define BOOT_FREQUENCY          5
+#else
+#error "SYSTEM_CLOCK must be one of the DCO frequencies in s_dcoFrequencies"
+#endif
+
+/** The entry of s_dcoFrequencies the system clock is running at right now. */
+static uint32_t currentFrequency = BOOT_FREQUENCY;
+
+/**
+ * Clock_now() is ticksBase plus the TIMER32_0 cycles counted since cyclesBase, shifted right by
+ * cycleShift (or left, when it is negative) to turn cycles at the current frequency into ticks.
+ * The bases move whenever the frequency changes or the processor wakes up from deep sleep.
+ */
+static uint64_t ticksBase = 0;
+static uint64_t cyclesBase = 0;
+static int32_t cycleShift = 0;
+
+/** Counts how many times the bases have moved, so that SWTimers can tell whether their fast path
+ *  still holds. */
+static volatile uint32_t clockEpoch = 0;
+
+/** The functions to call before and after every system frequency change. Either may be NULL. */
+#define MAX_CLOCK_LISTENERS     4
+
+static ClockListener beforeListeners[MAX_CLOCK_LISTENERS];
+static ClockListener afterListeners[MAX_CLOCK_LISTENERS];
+static uint32_t numListeners = 0;
 
 /**
  * The ISR used to increment the total number of rollovers which have passed. When the
  * TIMER32_0_BASE timer expires, this ISR is automatically called. DO NOT DIRECTLY INVOKE THIS
  * FUNCTION FROM YOUR CODE, or you WILL destroy the accuracy of ALL software timers in your code.
+ *
+ * Clock_now() relies on the count and the interrupt flag changing together, so this ISR must not be
+ * preempted by another ISR which reads the clock. Leave every interrupt at the same priority.
  */
 void ISR_Timer32_0_Rollover()
 {
@@ -25,9 +113,10 @@ void ISR_Timer32_0_Rollover()
  * Initializes the global system timing. This function should be called immediately after the
  * Watchdog timer is reset, so that the system clock is set appropriately.
  *
- * To change the system clock to different frequencies, use the #define on the SYSTEM_CLOCK in
- * Timer.h. DO NOT MODIFY THIS FUNCTION UNLESS YOU KNOW WHAT YOU ARE DOING. You can potentially
- * brick your board, which requires a factory reset to fix.
+ * To change the frequency the board boots at, use the #define on the SYSTEM_CLOCK in Timer.h, and
+ * to change it at runtime, use Clock_setSystemFrequency(). DO NOT MODIFY THIS FUNCTION UNLESS YOU
+ * KNOW WHAT YOU ARE DOING. You can potentially brick your board, which requires a factory reset to
+ * fix.
  */
 void InitSystemTiming()
 {
@@ -37,6 +126,11 @@ void InitSystemTiming()
     // Before initializing anything else, disable all interrupts
     Interrupt_disableMaster();
 
+    // Raise the core voltage first if the boot frequency needs it. system_msp432p401r.c has
+    // already done this when it booted the board at SYSTEM_CLOCK, so this is normally a no-op.
+    const DcoFrequency* boot = &s_dcoFrequencies[BOOT_FREQUENCY];
+    PCM_setCoreVoltageLevel(boot->coreVoltage);
+
     // Before changing the clock frequency, we need to change the flash control to use 2 wait
     // states (2 delayed cycles per flash read). IF YOU DO NOT CHANGE YOUR FLASH CONTROL BEFORE
     // CALLING CS_setDCOFrequency(), YOU WILL BRICK YOUR BOARD AND WILL NEED TO PERFORM A
@@ -52,13 +146,14 @@ void InitSystemTiming()
     FlashCtl_setWaitState(FLASH_BANK1, 2);
 
     // Set the system clock frequency to user-specified frequency
-    CS_setDCOFrequency(SYSTEM_CLOCK);
+    CS_setDCOCenteredFrequency(boot->dcoRange);
 
     // After DCO is set, configure all other clock signals to use a source from DCO.
     CS_initClockSignal(CS_MCLK  , CS_DCOCLK_SELECT , CS_CLOCK_DIVIDER_1);
     CS_initClockSignal(CS_HSMCLK, CS_DCOCLK_SELECT , CS_CLOCK_DIVIDER_1);
-    CS_initClockSignal(CS_SMCLK , CS_DCOCLK_SELECT , CS_CLOCK_DIVIDER_1);
+    CS_initClockSignal(CS_SMCLK , CS_DCOCLK_SELECT , boot->smclkDivider);
     CS_initClockSignal(CS_ACLK  , CS_REFOCLK_SELECT, CS_CLOCK_DIVIDER_1);
+    CS_initClockSignal(CS_BCLK  , CS_REFOCLK_SELECT, CS_CLOCK_DIVIDER_1);
 
     // Initialize the main hardware timer under which all other software timers are based. This
     // should be a periodic timer with the maximum load value supported and a prescaler of 1 in
@@ -71,17 +166,96 @@ void InitSystemTiming()
     // Starts the main reference hardware timer and enables an interrupt which counts rollovers
     Timer32_startTimer(TIMER32_0_BASE, false);
 
+    // Start the RTC from midnight on BCLK. Unlike TIMER32_0, it keeps counting in LPM3, which is
+    // how Clock_resume() finds out how long the processor was in deep sleep. Set the actual date
+    // and time with Clock_setWallTime().
+    RTC_C_Calendar midnight = { 0, 0, 0, 0, 1, 1, 2000 };
+    RTC_C_initCalendar(&midnight, RTC_C_FORMAT_BINARY);
+    RTC_C_startClock();
+
     // Enable interrupts again, after all system timing has been set up properly
     Interrupt_enableInterrupt(INT_T32_INT1);
     Interrupt_enableMaster();
 }
 
 /**
- * Constructs a new Software Timer, using a wait time in milliseconds. The timer uses the
- * hwTimerRollovers variable to keep track of its reference time, and is based off of time passing
- * under the TIMER32_0_BASE. When first constructed, this timer is NOT conditioned to start. Before
- * any calls to SWTimer_expired(), SWTimer_elapsedTimeUS(), or SWTimer_percentElapsed(), you MUST
- * FIRST CALL the SWTimer_start() method.
+ * A consistent reading of TIMER32_0: its counter, the number of rollovers counted so far, and
+ * whether another rollover has happened which the rollover ISR has not counted yet.
+ */
+struct _ClockSample
+{
+    uint32_t counter;
+    uint32_t rollovers;
+    bool pending;
+};
+typedef struct _ClockSample ClockSample;
+
+/**
+ * Reads TIMER32_0 and its rollover count as one consistent sample. The rollover count and the
+ * counter are two separate reads, and the counter may wrap in between. Read naively, that gives a
+ * result a whole period (2^32 cycles) too small, so this never tears:
+ * - If the rollover ISR runs anywhere in between the reads, the rollover count changes, and we
+ *   simply read everything again.
+ * - If the counter wraps but the rollover ISR cannot run yet, because we were called from an ISR or
+ *   with interrupts masked, its interrupt flag is still pending. Clock_cyclesAt() then takes care
+ *   of the rollover which has not been counted yet.
+ * No interrupts are masked, so this is safe to call from both ISRs and the main application.
+ *
+ * @return the sample
+ */
+static ClockSample Clock_sample(void)
+{
+    ClockSample sample;
+
+    do
+    {
+        sample.rollovers = hwTimerRollovers;
+        sample.counter = Timer32_getValue(TIMER32_0_BASE);
+        sample.pending = Timer32_getInterruptStatus(TIMER32_0_BASE) != 0;
+    } while (sample.rollovers != hwTimerRollovers);
+
+    return sample;
+}
+
+/**
+ * Returns the number of TIMER32_0_BASE cycles which had elapsed since the reference timer was
+ * started when a sample was taken, counting at whatever frequency the system clock has been running
+ * at. If a rollover was pending and the counter was read after the wrap, it is still close to
+ * LOADVALUE, and we count the pending rollover ourselves.
+ *
+ * @param sample:   The sample to convert
+ * @return the raw hardware cycle count
+ */
+static uint64_t Clock_cyclesAt(ClockSample sample)
+{
+    uint64_t periods = sample.rollovers;
+    if (sample.pending && sample.counter > LOADVALUE / 2)
+        periods++;
+
+    return (periods * TIMER_PERIOD) - sample.counter;
+}
+
+/**
+ * Converts a number of TIMER32_0_BASE cycles at the current system frequency into clock ticks.
+ *
+ * @param cycles:   The cycles to convert
+ * @return the number of clock ticks
+ */
+static uint64_t Clock_ticksFromCycles(uint64_t cycles)
+{
+    if (cycleShift >= 0)
+        return cycles >> cycleShift;
+    else
+        return cycles << -cycleShift;
+}
+
+/**
+ * Constructs a new Software Timer, using a wait time in milliseconds. The timer is based off of
+ * Clock_now(), so it keeps measuring real time when the system frequency changes. When first
+ * constructed, the timer is already considered to have expired. Before any calls to
+ * SWTimer_expired(), SWTimer_elapsedTimeUS(), or SWTimer_elapsedTimeMS(), you MUST FIRST CALL the
+ * SWTimer_start() method. For constant wait times, SWTIMER_INITIALIZER() does the same at compile
+ * time.
  *
  * @param waitTime_ms:  The amount of time this timer measures before expiration
  * @return a SWTimer object
@@ -90,46 +264,342 @@ SWTimer SWTimer_construct(uint64_t waitTime_ms)
 {
     SWTimer timer;
 
-    uint64_t counterClock = SYSTEM_CLOCK / PRESCALER;
-    uint64_t cyclesPerMillisecond = counterClock / MS_DIVISION_FACTOR;
-    timer.cyclesToWait = cyclesPerMillisecond * waitTime_ms;
+    timer.cyclesToWait = MS_TO_CLOCK_TICKS(waitTime_ms);
 
+    // Pretend the timer was started a full wait time before the clock started counting. There
+    // has always been at least one rollover since, so the fast path never applies.
+    timer.startTime = 0 - timer.cyclesToWait;
     timer.startCounter = 0;
     timer.startRollovers = 0;
+    timer.startEpoch = 0;
 
     return timer;
 }
 
 /**
- * Starts a constructed timer by reading the current number of rollovers and current load value in
- * TIMER32_0_BASE.
+ * Starts a constructed timer by taking a single sample of TIMER32_0_BASE, which gives both the
+ * Clock_now() timestamp to measure from and the counter values for the fast path.
  *
  * @param timer:    The SWTimer to start
  */
 void SWTimer_start(SWTimer* timer)
 {
-    timer->startCounter = Timer32_getValue(TIMER32_0_BASE);
-    timer->startRollovers = hwTimerRollovers;
+    ClockSample sample = Clock_sample();
+
+    timer->startTime = ticksBase + Clock_ticksFromCycles(Clock_cyclesAt(sample) - cyclesBase);
+    timer->startCounter = sample.counter;
+    timer->startEpoch = clockEpoch;
+
+    // A pending rollover has not been counted yet, so the rollover count is about to change and
+    // the fast path could not be trusted. Use a count which is never current instead.
+    timer->startRollovers = sample.pending ? 0 : sample.rollovers;
 }
 
 /**
  * A helper method to determine how many cycles have elapsed since the SWTimer started. As the user,
  * you most likely do NOT need to call this method outside of the Timer.c file. This method is used
- * in calculating how much time has elapsed for each of the methods below. If the timer was never
- * started, this function instead will return the number of cycles from the start of the program's
- * execution.
+ * in calculating how much time has elapsed for each of the methods below.
+ *
+ * In the common case, TIMER32_0_BASE has not rolled over and the bases of Clock_now() have not
+ * moved since the timer started, and the elapsed time is a single 32-bit subtraction of counter
+ * values - no loop, and no 64-bit arithmetic unless the system clock runs slower than at boot.
+ * Otherwise, the elapsed time is worked out from Clock_now() instead.
  *
  * @param timer:    The SWTimer with which we measure the number of cycles elapsed
- * @return the number of cycles elapsed since the timer started.
+ * @return the number of Clock_now() ticks elapsed since the timer started.
  */
 uint64_t SWTimer_elapsedCycles(SWTimer* timer)
 {
-    uint64_t rollovers = hwTimerRollovers - timer->startRollovers;
-    uint64_t startCounter = timer->startCounter;
-    uint64_t currentCounter = Timer32_getValue(TIMER32_0_BASE);
-    uint64_t elapsedCycles = (rollovers * LOADVALUE) + startCounter - currentCounter;
+    uint32_t rollovers = hwTimerRollovers;
+    uint32_t counter = Timer32_getValue(TIMER32_0_BASE);
 
-    return elapsedCycles;
+    // The pending check catches a wrap the rollover ISR has not counted yet, and the second read of
+    // the rollover count catches one it counted while we were looking.
+    if ((rollovers == timer->startRollovers) && (clockEpoch == timer->startEpoch)
+        && !Timer32_getInterruptStatus(TIMER32_0_BASE) && (rollovers == hwTimerRollovers))
+    {
+        uint32_t cycles = timer->startCounter - counter;
+
+        if (cycleShift >= 0)
+            return cycles >> cycleShift;
+        else
+            return (uint64_t) cycles << -cycleShift;
+    }
+
+    return Clock_now() - timer->startTime;
+}
+
+/**
+ * Converts clock ticks into milliseconds or microseconds with a reciprocal multiplication, which is
+ * exact for fewer than 2^31 ticks. Anything longer than that falls back to a division.
+ */
+static uint64_t Clock_ticksToMS(uint64_t ticks)
+{
+    if (ticks < (1ull << 31))
+        return ((uint64_t) (uint32_t) ticks * CLOCK_MS_RECIPROCAL) >> CLOCK_MS_SHIFT;
+
+    return ticks / CLOCK_TICKS_PER_MS;
+}
+
+static uint64_t Clock_ticksToUS(uint64_t ticks)
+{
+    if (ticks < (1ull << 31))
+        return ((uint64_t) (uint32_t) ticks * CLOCK_US_RECIPROCAL) >> CLOCK_US_SHIFT;
+
+    return (ticks * US_DIVISION_FACTOR) / CLOCK_TICKS_PER_SECOND;
+}
+
+/**
+ * @param timer:    A started SWTimer
+ * @return the number of milliseconds elapsed since the timer started
+ */
+uint64_t SWTimer_elapsedTimeMS(SWTimer* timer)
+{
+    return Clock_ticksToMS(SWTimer_elapsedCycles(timer));
+}
+
+/**
+ * @param timer:    A started SWTimer
+ * @return the number of microseconds elapsed since the timer started
+ */
+uint64_t SWTimer_elapsedTimeUS(SWTimer* timer)
+{
+    return Clock_ticksToUS(SWTimer_elapsedCycles(timer));
+}
+
+/**
+ * Returns the number of clock ticks which have elapsed since the reference timer was started, as a
+ * monotonic 64-bit timestamp. There are always CLOCK_TICKS_PER_SECOND ticks in a second, no matter
+ * which frequency the system clock runs at. Subtracting two timestamps gives the number of ticks
+ * between them, in the same units as SWTimer_elapsedCycles(). Use this to record WHEN something
+ * happened (for example, at the top of an ISR) so that the time can be examined later.
+ *
+ * @return the current timestamp, in clock ticks
+ */
+uint64_t Clock_now(void)
+{
+    return ticksBase + Clock_ticksFromCycles(Clock_cyclesAt(Clock_sample()) - cyclesBase);
+}
+
+/**
+ * Counts the days from 1 January 2000 until a date. Counting from March, as if January and
+ * February belonged to the year before, puts the leap day at the end of the year, where it does
+ * not affect the days before it.
+ *
+ * @param year:     The full year, 2000 or later
+ * @param month:    The month, from 1 to 12
+ * @param day:      The day of the month, from 1 to 31
+ * @return the number of days since 1 January 2000
+ */
+static uint32_t RTC_daysSince2000(uint32_t year, uint32_t month, uint32_t day)
+{
+    if (month <= 2)
+    {
+        year--;
+        month += 12;
+    }
+
+    uint32_t daysBeforeMonth = (153 * (month - 3) + 2) / 5;
+
+    return 365 * year + year / 4 - year / 100 + year / 400 + daysBeforeMonth + day - 1
+         - DAYS_UNTIL_2000;
+}
+
+/**
+ * Reads the RTC in 1/32768ths of a second since 1 January 2000. In calendar mode, RT0PS counts
+ * BCLK cycles and RT1PS counts RT0PS overflows, and the seconds count up whenever the low 7 bits of
+ * RT1PS wrap, so the low 15 bits of the prescalers are the fraction of the current second. The
+ * date is counted in too, so the result keeps increasing across midnight, however long the
+ * processor sleeps. The registers are updated asynchronously to the CPU, so we read until the
+ * seconds are the same on both sides.
+ *
+ * @return the time since 2000, in RTC ticks
+ */
+static uint64_t RTC_now(void)
+{
+    uint16_t time0, time1, date, year, prescaler;
+
+    do
+    {
+        time0 = RTC_C->TIM0;
+        time1 = RTC_C->TIM1;
+        date = RTC_C->DATE;
+        year = RTC_C->YEAR;
+        prescaler = RTC_C->PS;
+    } while (time0 != RTC_C->TIM0);
+
+    uint64_t days = RTC_daysSince2000(year & 0x0FFF, (date >> 8) & 0x0F, date & 0x1F);
+    uint64_t seconds = days * SECONDS_PER_DAY
+                     + (time1 & 0xFF) * 3600 + (time0 >> 8) * 60 + (time0 & 0xFF);
+
+    return seconds * RTC_TICKS_PER_SECOND + (prescaler & 0x7FFF);
+}
+
+/**
+ * Remembers the RTC time right before the processor enters deep sleep. Call this with interrupts
+ * masked, immediately before entering LPM3.
+ */
+void Clock_suspend(void)
+{
+    rtcAtSuspend = RTC_now();
+}
+
+/**
+ * Adds the time the processor spent in deep sleep to Clock_now() and all SWTimers. Call this with
+ * interrupts masked, immediately after waking up from LPM3 and before any ISR runs. The result is
+ * accurate to one RTC tick (about 31 us) per deep sleep, no matter how long the sleep was.
+ */
+void Clock_resume(void)
+{
+    // TIMER32_0 stood still while asleep, so the time slept only needs adding to the tick base.
+    uint64_t ticks = RTC_now() - rtcAtSuspend;
+    ticksBase += (ticks * CLOCK_TICKS_PER_SECOND) / RTC_TICKS_PER_SECOND;
+    clockEpoch++;
+}
+
+/**
+ * Sets the date and time of day the RTC keeps. The RTC runs from REFO in every power mode except
+ * LPM4, so the wall-clock time stays correct through deep sleep without the processor waking up.
+ * Clock_now() is not affected. Call this from the main application, never between
+ * Clock_suspend() and Clock_resume().
+ *
+ * @param time:     The current date and time, in binary (not BCD), in the year 2000 or later
+ */
+void Clock_setWallTime(const RTC_C_Calendar* time)
+{
+    RTC_C_initCalendar(time, RTC_C_FORMAT_BINARY);
+    RTC_C_startClock();
+}
+
+/**
+ * @return the date and time of day the RTC keeps, in binary
+ */
+RTC_C_Calendar Clock_wallTime(void)
+{
+    return RTC_C_getCalendarTime();
+}
+
+/**
+ * Moves the system clock from one DCO frequency to another. The core voltage and flash wait states
+ * must always be enough for the faster of the two frequencies, so they go up before the DCO does
+ * and come down after it. SMCLK is divided down before the DCO goes above 24 MHz for the same
+ * reason. Clock_now() is rebased right at the switch, so that the cycles counted before it are
+ * converted at the old frequency and the ones after it at the new one.
+ *
+ * @param from:     The frequency the system clock is running at
+ * @param to:       The frequency to switch the system clock to
+ */
+static void DcoFrequency_switch(const DcoFrequency* from, const DcoFrequency* to)
+{
+    bool raising = to->frequency > from->frequency;
+
+    if (raising)
+    {
+        PCM_setCoreVoltageLevel(to->coreVoltage);
+        FlashCtl_setWaitState(FLASH_BANK0, to->waitStates);
+        FlashCtl_setWaitState(FLASH_BANK1, to->waitStates);
+        CS_initClockSignal(CS_SMCLK, CS_DCOCLK_SELECT, to->smclkDivider);
+    }
+
+    uint64_t cycles = Clock_cyclesAt(Clock_sample());
+    ticksBase += Clock_ticksFromCycles(cycles - cyclesBase);
+    cyclesBase = cycles;
+    clockEpoch++;
+    CS_setDCOCenteredFrequency(to->dcoRange);
+    cycleShift = (int32_t) (to - s_dcoFrequencies) - BOOT_FREQUENCY;
+
+    if (!raising)
+    {
+        CS_initClockSignal(CS_SMCLK, CS_DCOCLK_SELECT, to->smclkDivider);
+        FlashCtl_setWaitState(FLASH_BANK0, to->waitStates);
+        FlashCtl_setWaitState(FLASH_BANK1, to->waitStates);
+        PCM_setCoreVoltageLevel(to->coreVoltage);
+    }
+}
+
+/**
+ * Switches MCLK, HSMCLK and SMCLK to another DCO frequency at runtime. Clock_now() and every SWTimer
+ * keep counting real time across the switch. Every registered ClockListener is called twice: once
+ * before the switch, so that peripherals running from SMCLK can finish what they are sending at the
+ * old frequency, and once afterwards, so that they can follow. Supported frequencies are 1.5, 3, 6,
+ * 12, 24 and 48 MHz.
+ *
+ * @param frequency:    The new MCLK frequency, in Hz
+ * @return true if the system clock now runs at [frequency], false if it is not supported
+ */
+bool Clock_setSystemFrequency(uint32_t frequency)
+{
+    uint32_t i;
+    for (i = 0; i < NUM_DCO_FREQUENCIES; i++)
+    {
+        if (s_dcoFrequencies[i].frequency == frequency)
+            break;
+    }
+
+    if (i == NUM_DCO_FREQUENCIES)
+        return false;
+
+    if (i == currentFrequency)
+        return true;
+
+    uint32_t j;
+    for (j = 0; j < numListeners; j++)
+    {
+        if (beforeListeners[j])
+            beforeListeners[j]();
+    }
+
+    // Nothing may read Clock_now() while its bases are moving.
+    bool wasDisabled = Interrupt_disableMaster();
+    DcoFrequency_switch(&s_dcoFrequencies[currentFrequency], &s_dcoFrequencies[i]);
+    currentFrequency = i;
+    SystemCoreClock = frequency;
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+
+    for (j = 0; j < numListeners; j++)
+    {
+        if (afterListeners[j])
+            afterListeners[j]();
+    }
+
+    return true;
+}
+
+/**
+ * @return the frequency MCLK and HSMCLK currently run at, in Hz
+ */
+uint32_t Clock_systemFrequency(void)
+{
+    return s_dcoFrequencies[currentFrequency].frequency;
+}
+
+/**
+ * @return the frequency SMCLK currently runs at, in Hz
+ */
+uint32_t Clock_peripheralFrequency(void)
+{
+    return s_dcoFrequencies[currentFrequency].peripheralFrequency;
+}
+
+/**
+ * Registers functions to call before and after every change of the system frequency, both from the
+ * main application with interrupts enabled. [before] runs while SMCLK is still at the old
+ * frequency, and [after] once it runs at the new one.
+ *
+ * @param before:       The function to call before the switch, or NULL
+ * @param after:        The function to call after the switch, or NULL
+ * @return true if the listeners were registered, false if there is no room left
+ */
+bool Clock_addFrequencyListener(ClockListener before, ClockListener after)
+{
+    if (numListeners == MAX_CLOCK_LISTENERS)
+        return false;
+
+    beforeListeners[numListeners] = before;
+    afterListeners[numListeners] = after;
+    numListeners++;
+    return true;
 }
 
 /**
@@ -143,3 +613,74 @@ bool SWTimer_expired(SWTimer* timer)
     uint64_t elapsedCycles = SWTimer_elapsedCycles(timer);
     return elapsedCycles >= timer->cyclesToWait;
 }
+
+#ifdef SWTIMER_BENCHMARK
+
+#define BENCHMARK_CALLS         (64)
+
+/** Results are stored here so the compiler cannot drop the calls being measured. */
+static volatile uint64_t benchmarkSink;
+
+/**
+ * Measures the average number of SysTick cycles (one per MCLK cycle) a query takes, minus the cost
+ * of the loop around it. SysTick counts down, so the elapsed cycles are start minus end.
+ */
+#define BENCHMARK(result, call)                                                                 \
+    do                                                                                          \
+    {                                                                                           \
+        uint32_t i, cycles;                                                                     \
+        uint32_t start = SysTick_getValue();                                                    \
+        for (i = 0; i < BENCHMARK_CALLS; i++)                                                   \
+            benchmarkSink = (call);                                                             \
+        cycles = (start - SysTick_getValue()) & 0x00FFFFFF;                                     \
+        result = (cycles > overhead) ? (cycles - overhead) / BENCHMARK_CALLS : 0;               \
+    } while (0)
+
+/**
+ * The conversions as they would be without the fast path or the reciprocals: through Clock_now(),
+ * with a 64-bit division. Only kept as a baseline for the benchmark.
+ */
+static uint64_t SWTimer_divisionElapsedMS(SWTimer* timer)
+{
+    return (Clock_now() - timer->startTime) / CLOCK_TICKS_PER_MS;
+}
+
+static uint64_t SWTimer_divisionElapsedUS(SWTimer* timer)
+{
+    return ((Clock_now() - timer->startTime) * US_DIVISION_FACTOR) / CLOCK_TICKS_PER_SECOND;
+}
+
+/**
+ * Counts the CPU cycles each SWTimer query takes, to check that the fast path is worth having on
+ * the board. SysTick is taken over for the duration and left running afterwards. A TIMER32_0
+ * rollover in the middle of a measurement makes it a little slower than usual, so run this a few
+ * times and keep the smallest numbers.
+ *
+ * @return the average cycles per call of each query, and of the division-based baseline
+ */
+SWTimerBenchmark SWTimer_benchmark(void)
+{
+    SWTimerBenchmark benchmark;
+    uint32_t overhead = 0;
+
+    SysTick_setPeriod(0x01000000);
+    SysTick_enableModule();
+
+    // A timer which has never been started always takes the slow path.
+    SWTimer started = SWTimer_construct(1000);
+    SWTimer stale = SWTimer_construct(1000);
+    SWTimer_start(&started);
+
+    BENCHMARK(overhead, 0);
+    BENCHMARK(benchmark.elapsedFast, SWTimer_elapsedCycles(&started));
+    BENCHMARK(benchmark.elapsedSlow, SWTimer_elapsedCycles(&stale));
+    BENCHMARK(benchmark.elapsedMS, SWTimer_elapsedTimeMS(&started));
+    BENCHMARK(benchmark.elapsedUS, SWTimer_elapsedTimeUS(&started));
+    BENCHMARK(benchmark.divisionMS, SWTimer_divisionElapsedMS(&started));
+    BENCHMARK(benchmark.divisionUS, SWTimer_divisionElapsedUS(&started));
+    BENCHMARK(benchmark.now, Clock_now());
+
+    return benchmark;
+}
+
+#endif
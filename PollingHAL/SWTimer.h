@@ -13,14 +13,54 @@
 #define MS_DIVISION_FACTOR  1000        // Number of milliseconds in one second
 #define US_DIVISION_FACTOR  1000000     // Number of microseconds in one second
 
-// A globally-defined system clock variable. Changing this variable will change the system clock
-// across the ENTIRE BOARD. Any API calls which use the system clock as part of its timing therefore
-// should parameterize their variables to this #define and thus #include <PollingHAL/SWTimer.h>.
+// The frequency MCLK, HSMCLK and SMCLK run at after InitSystemTiming(). Keep __SYSTEM_CLOCK in
+// system_msp432p401r.c equal to it, so that the board boots at the same frequency. It must be one
+// of the DCO frequencies listed in Clock_setSystemFrequency(). To change the clock at runtime, use
+// Clock_setSystemFrequency(), and to find out what it currently is, use Clock_systemFrequency() -
+// never assume it is SYSTEM_CLOCK.
 #define SYSTEM_CLOCK        3000000
 
 #define LOADVALUE           0xFFFFFFFF
 #define PRESCALER           1
 
+// Clock_now() and all SWTimers count in a fixed time base of CLOCK_TICKS_PER_SECOND ticks, no
+// matter which frequency the system clock is running at. Use these instead of SYSTEM_CLOCK to
+// convert between ticks and real time.
+#define CLOCK_TICKS_PER_SECOND  (SYSTEM_CLOCK / PRESCALER)
+#define CLOCK_TICKS_PER_MS      (CLOCK_TICKS_PER_SECOND / MS_DIVISION_FACTOR)
+
+// Converts a constant number of milliseconds into Clock_now() ticks at compile time.
+#define MS_TO_CLOCK_TICKS(ms)   ((uint64_t) (ms) * CLOCK_TICKS_PER_MS)
+
+// Ticks are turned into milliseconds and microseconds by multiplying with a 32-bit reciprocal of
+// the number of ticks per unit and shifting, instead of dividing: x * units / ticks-per-second is
+// (x * RECIPROCAL) >> SHIFT, exactly, for every x below 2^31. The shift is 32 plus the number of
+// bits in the ticks per unit (minus one), which keeps the reciprocal as precise as 32 bits allow.
+#if   CLOCK_TICKS_PER_SECOND > 32768000
+#define CLOCK_MS_SHIFT          47
+#elif CLOCK_TICKS_PER_SECOND > 16384000
+#define CLOCK_MS_SHIFT          46
+#elif CLOCK_TICKS_PER_SECOND > 8192000
+#define CLOCK_MS_SHIFT          45
+#elif CLOCK_TICKS_PER_SECOND > 4096000
+#define CLOCK_MS_SHIFT          44
+#elif CLOCK_TICKS_PER_SECOND > 2048000
+#define CLOCK_MS_SHIFT          43
+#elif CLOCK_TICKS_PER_SECOND > 1024000
+#define CLOCK_MS_SHIFT          42
+#else
+#error "CLOCK_TICKS_PER_SECOND must be above 1024000"
+#endif
+
+#define CLOCK_US_SHIFT          (CLOCK_MS_SHIFT - 10)
+
+#define CLOCK_RECIPROCAL(units, shift)                                                            \
+    ((uint32_t) ((((uint64_t) (units) << (shift)) + CLOCK_TICKS_PER_SECOND - 1)                   \
+                 / CLOCK_TICKS_PER_SECOND))
+
+#define CLOCK_MS_RECIPROCAL     CLOCK_RECIPROCAL(MS_DIVISION_FACTOR, CLOCK_MS_SHIFT)
+#define CLOCK_US_RECIPROCAL     CLOCK_RECIPROCAL(US_DIVISION_FACTOR, CLOCK_US_SHIFT)
+
 /**=================================================================================================
  * A Software timer object, implemented in the C object-oriented style. Use the constructor
  * [SWTimer_construct()] to create a software timer. The only method which works after a timer is
@@ -40,20 +80,31 @@
  */
 struct _SWTimer
 {
-    // The number of hardware timer cycles which must elapse before the timer expires
+    // The number of Clock_now() ticks which must elapse before the timer expires
     uint64_t cyclesToWait;
 
-    // The starting counter value of the hardware timer, set when the timer is started
-    uint32_t startCounter;
+    // The Clock_now() timestamp at which the timer was started
+    uint64_t startTime;
 
-    // The starting rollover value of the hardware timer, set when the timer is started
+    // The hardware timer's counter, rollover count and clock epoch when the timer was started. As
+    // long as the rollover count and epoch have not changed since, the elapsed time is a 32-bit
+    // subtraction of counter values.
+    uint32_t startCounter;
     uint32_t startRollovers;
+    uint32_t startEpoch;
 };
 typedef struct _SWTimer SWTimer;
 
 // Constructs a Software timer. All timers must be constructed before starting them.
 SWTimer SWTimer_construct(uint64_t waitTime_ms);
 
+// Constructs a Software timer for a constant wait time entirely at compile time, so that it can
+// initialize a static or global timer as well:
+//     static SWTimer debounceTimer = SWTIMER_INITIALIZER(50);
+// Like SWTimer_construct(), the timer is already considered to have expired.
+#define SWTIMER_INITIALIZER(waitTime_ms)                                                          \
+    { MS_TO_CLOCK_TICKS(waitTime_ms), 0 - MS_TO_CLOCK_TICKS(waitTime_ms), 0, 0, 0 }
+
 // Starts a software timer. All constructed timers must be started before use.
 void SWTimer_start(SWTimer* timer);
 
@@ -61,8 +112,64 @@ void SWTimer_start(SWTimer* timer);
 // timer was started. You do not need to call this function outside of Timer.c.
 uint64_t SWTimer_elapsedCycles(SWTimer* timer);
 
+// Returns how long ago the timer was started, in milliseconds or microseconds.
+uint64_t SWTimer_elapsedTimeMS(SWTimer* timer);
+uint64_t SWTimer_elapsedTimeUS(SWTimer* timer);
+
 bool SWTimer_expired(SWTimer* timer);
 
+// Returns a 64-bit monotonic timestamp, counted in CLOCK_TICKS_PER_SECOND ticks per second even
+// across system frequency changes. Safe to call from both ISRs and the main application, and never
+// off by a hardware timer rollover, without masking interrupts.
+uint64_t Clock_now(void);
+
+// Keeps Clock_now() and all SWTimers counting through deep sleep (LPM3), during which TIMER32_0
+// stops. Call Clock_suspend() right before entering LPM3 and Clock_resume() right after waking up,
+// both with interrupts masked. The time slept is measured with the RTC, which runs on REFO, and
+// may be anything from microseconds to years.
+void Clock_suspend(void);
+void Clock_resume(void);
+
+// The date and time of day, kept by the RTC through every power mode except LPM4. The RTC starts
+// at midnight on 1 January 2000 in InitSystemTiming(). All fields are in binary, not BCD.
+void Clock_setWallTime(const RTC_C_Calendar* time);
+RTC_C_Calendar Clock_wallTime(void);
+
+// Switches MCLK, HSMCLK and SMCLK to another DCO frequency at runtime, along with the core voltage
+// level and flash wait states that frequency needs. Returns false, and changes nothing, if the
+// frequency is not one of the DCO frequencies listed in SWTimer.c. Call this from the main
+// application only, never from an ISR.
+bool Clock_setSystemFrequency(uint32_t frequency);
+
+// The frequency MCLK and HSMCLK currently run at, and the frequency SMCLK currently runs at. SMCLK
+// is limited to 24 MHz, so it is divided down when the system clock is faster than that.
+uint32_t Clock_systemFrequency(void);
+uint32_t Clock_peripheralFrequency(void);
+
+// Registers functions to be called before and after every system frequency change, so that
+// peripherals clocked from SMCLK can finish sending at the old frequency and then recompute their
+// dividers. Either may be NULL. Returns false if there is no room for another pair.
+typedef void (*ClockListener)(void);
+bool Clock_addFrequencyListener(ClockListener before, ClockListener after);
+
+#ifdef SWTIMER_BENCHMARK
+// CPU cycles taken by one call of each SWTimer query, averaged over many calls and measured with
+// SysTick. Build with SWTIMER_BENCHMARK defined, and run with interrupts enabled.
+struct _SWTimerBenchmark
+{
+    uint32_t elapsedFast;   // SWTimer_elapsedCycles() with no rollover since the timer started
+    uint32_t elapsedSlow;   // SWTimer_elapsedCycles() after a rollover, through Clock_now()
+    uint32_t elapsedMS;     // SWTimer_elapsedTimeMS(), including the reciprocal multiply
+    uint32_t elapsedUS;     // SWTimer_elapsedTimeUS(), including the reciprocal multiply
+    uint32_t divisionMS;    // The same two through Clock_now() and a 64-bit division, as a
+    uint32_t divisionUS;    // baseline for the two above
+    uint32_t now;           // Clock_now()
+};
+typedef struct _SWTimerBenchmark SWTimerBenchmark;
+
+SWTimerBenchmark SWTimer_benchmark(void);
+#endif
+
 // Initializes the global clock system for the MSP432, as well as a hardware
 // timer under which all of the software timers are based.
 void InitSystemTiming();
@@ -0,0 +1,150 @@
+/*
+ * Profiler.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ */
+
+#ifdef __linux__
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#else
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#endif
+
+#include <Profiler.h>
+
+/* The number of empty regions timed to find the cost of profiling itself. */
+#define CALIBRATION_RUNS            (16)
+
+/**
+ * The profiler's table. [start] is when each region last began. [overhead] is
+ * the time an empty region takes, which is taken off every run so that short
+ * regions are not dominated by the cost of measuring them.
+ */
+struct _Profiler
+{
+    ProfileStats stats[NUM_PROFILE_REGIONS];
+    uint32_t start[NUM_PROFILE_REGIONS];
+    uint32_t overhead;
+};
+typedef struct _Profiler Profiler;
+
+/* The single instance of the profiler's table. */
+static Profiler s_profiler;
+
+/**
+ * Reads the free-running counter which run times are measured with. Both
+ * counters wrap around, so only differences between two readings mean
+ * anything: at 48 MHz, the cycle counter wraps every 89 seconds, and the
+ * nanosecond counter every 4 seconds.
+ *
+ * @return the current count, in CPU cycles (or nanoseconds on Linux)
+ */
+static uint32_t Profiler_now(void)
+{
+#ifdef __linux__
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t) ((uint64_t) now.tv_sec * 1000000000 + now.tv_nsec);
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+/**
+ * Starts the cycle counter, clears every region, and measures the overhead of
+ * an empty region. The DWT cycle counter only counts once trace is enabled in
+ * the debug unit, which the debugger normally does, but not in a standalone
+ * boot. Call this once, through [PROFILE_INIT()], before profiling anything.
+ */
+void Profiler_init(void)
+{
+#ifndef __linux__
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    s_profiler.overhead = 0;
+    Profiler_reset();
+
+    int i;
+    for (i = 0; i < CALIBRATION_RUNS; i++)
+    {
+        Profiler_begin(PROFILE_DISPATCH);
+        Profiler_end(PROFILE_DISPATCH);
+    }
+
+    s_profiler.overhead = s_profiler.stats[PROFILE_DISPATCH].min;
+    Profiler_reset();
+}
+
+/**
+ * Marks the start of a run of a region.
+ *
+ * @param region:   The region which is starting
+ */
+void Profiler_begin(ProfileRegion region)
+{
+    s_profiler.start[region] = Profiler_now();
+}
+
+/**
+ * Marks the end of a run of a region, and adds the run to the region's stats.
+ *
+ * @param region:   The region which is ending, which must have begun
+ */
+void Profiler_end(ProfileRegion region)
+{
+    uint32_t elapsed = Profiler_now() - s_profiler.start[region];
+    elapsed = (elapsed > s_profiler.overhead)
+            ? elapsed - s_profiler.overhead : 0;
+
+    ProfileStats* stats = &s_profiler.stats[region];
+    stats->count++;
+    stats->total += elapsed;
+
+    if (elapsed < stats->min)
+        stats->min = elapsed;
+
+    if (elapsed > stats->max)
+        stats->max = elapsed;
+}
+
+/**
+ * Returns a copy of one region's stats. On the MSP432, interrupts are masked
+ * while copying, so an ISR cannot end a run halfway through the copy.
+ *
+ * @param region:   The region to look at
+ * @return the region's stats, in CPU cycles (or nanoseconds on Linux). [min]
+ *         is UINT32_MAX if the region has not run yet.
+ */
+ProfileStats Profiler_stats(ProfileRegion region)
+{
+#ifdef __linux__
+    return s_profiler.stats[region];
+#else
+    bool wasDisabled = Interrupt_disableMaster();
+    ProfileStats stats = s_profiler.stats[region];
+
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+
+    return stats;
+#endif
+}
+
+/** Discards every run measured so far, of every region. */
+void Profiler_reset(void)
+{
+    int i;
+    for (i = 0; i < NUM_PROFILE_REGIONS; i++)
+    {
+        s_profiler.stats[i].count = 0;
+        s_profiler.stats[i].min = UINT32_MAX;
+        s_profiler.stats[i].max = 0;
+        s_profiler.stats[i].total = 0;
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Profiler.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  A region profiler, for finding out where the cycles actually go. Wrap a
+ *  region of code in [PROFILE_BEGIN()] and [PROFILE_END()], and the profiler
+ *  keeps the number of runs and the shortest, longest and total run time of
+ *  each region in a static table. On the MSP432, run times are counted in CPU
+ *  cycles with the Cortex-M4 DWT cycle counter. Built for Linux, they are
+ *  counted in nanoseconds with clock_gettime() instead, so the same
+ *  instrumented code can be profiled on a host machine.
+ *
+ *  Profiling costs a few cycles per region, so it is compiled out entirely
+ *  unless PROFILING is defined. Every macro below then expands to nothing.
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+
+/**
+ * The regions which can be profiled. A region's time includes every region
+ * nested inside it, as well as any ISR which preempts it.
+ *
+ * TODO: Add an ID for every region of your own you want to profile.
+ */
+enum _ProfileRegion
+{
+    PROFILE_LCD_WRITE_COMMAND,      // HAL_LCD_writeCommand()
+    PROFILE_LCD_WRITE_DATA,         // HAL_LCD_writeData()
+    PROFILE_LCD_PIXEL_DRAW,         // Crystalfontz128x128 drawing primitives
+    PROFILE_LCD_PIXEL_DRAW_MULTIPLE,
+    PROFILE_LCD_LINE_DRAW_H,
+    PROFILE_LCD_LINE_DRAW_V,
+    PROFILE_LCD_RECT_FILL,
+    PROFILE_GPIO_ISR,               // Every GPIO port ISR in InterruptHAL.c
+    PROFILE_DISPATCH,               // EventLoop_dispatch() in Main.c
+
+    NUM_PROFILE_REGIONS
+};
+typedef enum _ProfileRegion ProfileRegion;
+
+/** What the profiler has measured for one region, in cycles (or ns). */
+struct _ProfileStats
+{
+    uint32_t count;     // Number of times the region ran
+    uint32_t min;       // Shortest run
+    uint32_t max;       // Longest run
+    uint64_t total;     // Sum of all runs
+};
+typedef struct _ProfileStats ProfileStats;
+
+#ifdef PROFILING
+
+#define PROFILE_INIT()              Profiler_init()
+#define PROFILE_BEGIN(region)       Profiler_begin(region)
+#define PROFILE_END(region)         Profiler_end(region)
+
+#else
+
+#define PROFILE_INIT()              ((void) 0)
+#define PROFILE_BEGIN(region)       ((void) 0)
+#define PROFILE_END(region)         ((void) 0)
+
+#endif
+
+/* Starts the cycle counter and clears every region. Use [PROFILE_INIT()]. */
+void Profiler_init(void);
+
+/* Use [PROFILE_BEGIN()] and [PROFILE_END()] instead of calling these. A region
+ * must not be begun again before it ends, but regions may nest. */
+void Profiler_begin(ProfileRegion region);
+void Profiler_end(ProfileRegion region);
+
+ProfileStats Profiler_stats(ProfileRegion region);
+void Profiler_reset(void);
+
+#endif /* PROFILER_H_ */
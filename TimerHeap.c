@@ -0,0 +1,175 @@
+/*
+ * TimerHeap.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ */
+
+#include <TimerHeap.h>
+#include <stddef.h>
+
+/* The parent and first child of a heap position. */
+#define PARENT(index)               (((index) - 1) / 2)
+#define LEFT_CHILD(index)           (2 * (index) + 1)
+
+/**
+ * Constructs a timer which calls [callback] from an ISR whenever it expires.
+ *
+ * @param callback:     The function to call on expiry
+ * @return a SoftTimer which is not running yet
+ */
+SoftTimer SoftTimer_constructCallback(SoftTimerCallback callback)
+{
+    SoftTimer timer;
+
+    timer.deadline = 0;
+    timer.period = 0;
+    timer.callback = callback;
+    timer.id = NUM_EVENT_IDS;
+    timer.heapIndex = TIMER_NOT_RUNNING;
+
+    return timer;
+}
+
+/**
+ * Constructs a timer which logs event [id] whenever it expires, to be handled
+ * by the main application like any other event, policies included.
+ *
+ * @param id:   The event to log on expiry
+ * @return a SoftTimer which is not running yet
+ */
+SoftTimer SoftTimer_constructEvent(EventId id)
+{
+    SoftTimer timer = SoftTimer_constructCallback(NULL);
+    timer.id = id;
+
+    return timer;
+}
+
+/** Returns whether a timer has been started and has not expired or been
+ *  cancelled since. Periodic timers keep running until they are cancelled. */
+bool SoftTimer_isRunning(const SoftTimer* timer)
+{
+    return timer->heapIndex != TIMER_NOT_RUNNING;
+}
+
+/** Puts [timer] at [index] and tells it where it now is. */
+static void Place(TimerHeap* heap, uint8_t index, SoftTimer* timer)
+{
+    heap->timers[index] = timer;
+    timer->heapIndex = index;
+}
+
+/**
+ * Moves the timer at [index] towards the root until its parent expires no
+ * later than it does.
+ */
+static void SiftUp(TimerHeap* heap, uint8_t index)
+{
+    SoftTimer* timer = heap->timers[index];
+
+    while (index > 0)
+    {
+        SoftTimer* parent = heap->timers[PARENT(index)];
+        if (parent->deadline <= timer->deadline)
+            break;
+
+        Place(heap, index, parent);
+        index = PARENT(index);
+    }
+
+    Place(heap, index, timer);
+}
+
+/**
+ * Moves the timer at [index] towards the leaves until both of its children
+ * expire no earlier than it does.
+ */
+static void SiftDown(TimerHeap* heap, uint8_t index)
+{
+    SoftTimer* timer = heap->timers[index];
+
+    while (LEFT_CHILD(index) < heap->size)
+    {
+        uint8_t child = LEFT_CHILD(index);
+
+        if ((child + 1 < heap->size)
+            && (heap->timers[child + 1]->deadline
+                < heap->timers[child]->deadline))
+        {
+            child++;
+        }
+
+        if (timer->deadline <= heap->timers[child]->deadline)
+            break;
+
+        Place(heap, index, heap->timers[child]);
+        index = child;
+    }
+
+    Place(heap, index, timer);
+}
+
+/** Empties the heap. Does not touch any of the timers which were in it. */
+void TimerHeap_init(TimerHeap* heap)
+{
+    heap->size = 0;
+}
+
+/**
+ * Adds a timer to the heap in O(log n), ordered by its [deadline]. The timer
+ * must not already be in a heap.
+ *
+ * @param heap:     The heap to insert into
+ * @param timer:    The timer to insert
+ * @return true if the timer was inserted, false if the heap was full
+ */
+bool TimerHeap_insert(TimerHeap* heap, SoftTimer* timer)
+{
+    if (heap->size == TIMER_HEAP_CAPACITY)
+        return false;
+
+    Place(heap, heap->size, timer);
+    heap->size++;
+    SiftUp(heap, timer->heapIndex);
+
+    return true;
+}
+
+/**
+ * Removes a timer from the heap in O(log n). The last timer in the heap takes
+ * its place, and is then sifted whichever way its deadline requires.
+ *
+ * @param heap:     The heap to remove from
+ * @param timer:    The timer to remove, which must be in [heap]
+ */
+void TimerHeap_remove(TimerHeap* heap, SoftTimer* timer)
+{
+    uint8_t index = timer->heapIndex;
+    timer->heapIndex = TIMER_NOT_RUNNING;
+
+    heap->size--;
+    if (index == heap->size)
+        return;
+
+    Place(heap, index, heap->timers[heap->size]);
+
+    if ((index > 0)
+        && (heap->timers[index]->deadline
+            < heap->timers[PARENT(index)]->deadline))
+    {
+        SiftUp(heap, index);
+    }
+    else
+    {
+        SiftDown(heap, index);
+    }
+}
+
+/**
+ * @return the timer with the earliest deadline, or NULL if the heap is empty
+ */
+SoftTimer* TimerHeap_peek(const TimerHeap* heap)
+{
+    return (heap->size == 0) ? NULL : heap->timers[0];
+}
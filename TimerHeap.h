@@ -0,0 +1,80 @@
+/*
+ * TimerHeap.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: agent
+ *
+ *  Software timers, and a fixed-capacity binary min-heap which orders them by
+ *  deadline. The earliest deadline is always at the root, so whoever services
+ *  the timers only ever has to program one hardware compare for it. Every timer
+ *  remembers where it sits in the heap, which makes cancelling one O(log n)
+ *  instead of a linear search. Like the latency histograms, this module only
+ *  deals with numbers - it never reads a clock itself and has no hardware
+ *  dependencies.
+ */
+
+#ifndef TIMERHEAP_H_
+#define TIMERHEAP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <EventQueue.h>
+
+/* The number of timers which can be running at the same time. Any number of
+ * timers can be constructed, but only this many can be started at once. */
+#define TIMER_HEAP_CAPACITY         (16)
+
+/* The [heapIndex] of a timer which is not running. */
+#define TIMER_NOT_RUNNING           (0xFF)
+
+typedef struct _SoftTimer SoftTimer;
+
+/**
+ * Called from an ISR whenever a timer expires. A periodic timer has already
+ * been rescheduled by then, so the callback may cancel or restart it freely.
+ */
+typedef void (*SoftTimerCallback)(SoftTimer* timer);
+
+/**
+ * A software timer. Construct one with [SoftTimer_constructCallback()] or
+ * [SoftTimer_constructEvent()], then start it with [InterruptHal_StartTimer()].
+ * The timer must stay in memory (i.e. be static or global) for as long as it is
+ * running. As with the SWTimer, treat all members as PRIVATE.
+ */
+struct _SoftTimer
+{
+    uint64_t deadline;          // When the timer next expires, in clock ticks
+    uint64_t period;            // Time between expiries, or 0 for a one-shot
+
+    SoftTimerCallback callback; // Called on expiry, or NULL to log [id]
+    EventId id;                 // The event to log on expiry
+
+    uint8_t heapIndex;          // Where the timer is in the heap, if running
+};
+
+SoftTimer SoftTimer_constructCallback(SoftTimerCallback callback);
+SoftTimer SoftTimer_constructEvent(EventId id);
+
+bool SoftTimer_isRunning(const SoftTimer* timer);
+
+/** The heap itself. [timers[0]] has the earliest deadline. */
+struct _TimerHeap
+{
+    SoftTimer* timers[TIMER_HEAP_CAPACITY];
+    uint8_t size;
+};
+typedef struct _TimerHeap TimerHeap;
+
+void TimerHeap_init(TimerHeap* heap);
+
+/* Adds a timer which is not running, ordered by its [deadline]. Returns false,
+ * and changes nothing, if the heap is full. */
+bool TimerHeap_insert(TimerHeap* heap, SoftTimer* timer);
+
+/* Removes a running timer from the heap. */
+void TimerHeap_remove(TimerHeap* heap, SoftTimer* timer);
+
+/* Returns the timer with the earliest deadline, or NULL if there is none. */
+SoftTimer* TimerHeap_peek(const TimerHeap* heap);
+
+#endif /* TIMERHEAP_H_ */
@@ -68,6 +68,7 @@
 //     <12000000> 12 MHz
 //     <24000000> 24 MHz
 //     <48000000> 48 MHz
+//   Keep equal to SYSTEM_CLOCK in PollingHAL/SWTimer.h
 #define  __SYSTEM_CLOCK    3000000
 
 /*--------------------- Power Regulator Configuration -----------------------*/